@@ -0,0 +1,32 @@
+#include "AsyncLoader.hpp"
+
+void AsyncLoader::start(Job job){
+    join();
+    m_done = false; m_progress = 0.f; m_stage = "";
+    m_stages.clear(); m_totalMs = 0.0;
+
+    m_thread = std::thread([this, job = std::move(job)]{
+        auto msSince = [](Clock::time_point t){
+            return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+        };
+        const auto t0 = Clock::now();
+        auto stageStart = t0;
+        Progress report = [&](float p, const char* name){
+            // Close the previous stage and open the new one
+            if(!m_stages.empty()) m_stages.back().ms = msSince(stageStart);
+            stageStart = Clock::now();
+            m_stages.push_back({name, 0.0});
+            m_stage.store(name, std::memory_order_relaxed);
+            m_progress.store(p, std::memory_order_relaxed);
+        };
+        job(report);
+        if(!m_stages.empty()) m_stages.back().ms = msSince(stageStart);
+        m_totalMs = msSince(t0);
+        m_progress.store(1.f, std::memory_order_relaxed);
+        m_done.store(true, std::memory_order_release);
+    });
+}
+
+void AsyncLoader::join(){
+    if(m_thread.joinable()) m_thread.join();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Runs a loading job on a background thread. The job reports progress through
+// the callback it receives (0..1 plus a stage name, string literals only);
+// the main thread polls progress()/stage()/done() while it keeps drawing.
+// Each stage's wall time is recorded so startup cost can be tracked.
+class AsyncLoader {
+public:
+    using Progress = std::function<void(float progress, const char* stage)>;
+    using Job      = std::function<void(const Progress&)>;
+
+    struct StageTime { const char* name; double ms; };
+
+    AsyncLoader() = default;
+    AsyncLoader(const AsyncLoader&) = delete;
+    AsyncLoader& operator=(const AsyncLoader&) = delete;
+    ~AsyncLoader(){ join(); }
+
+    void start(Job job);
+    void join();
+
+    bool        done()     const { return m_done.load(std::memory_order_acquire); }
+    float       progress() const { return m_progress.load(std::memory_order_relaxed); }
+    const char* stage()    const { return m_stage.load(std::memory_order_relaxed); }
+
+    // Valid once done() is true
+    const std::vector<StageTime>& stages() const { return m_stages; }
+    double totalMs() const { return m_totalMs; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::thread              m_thread;
+    std::atomic<bool>        m_done{false};
+    std::atomic<float>       m_progress{0.f};
+    std::atomic<const char*> m_stage{""};
+    std::vector<StageTime>   m_stages;   // written by the worker only
+    double                   m_totalMs{0.0};
+};
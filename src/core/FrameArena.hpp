@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Linear allocator for data that only lives during one frame (scratch vectors
+// in input/simulation). Allocation is a pointer bump, deallocation is a no-op
+// and Game::run calls reset() once per loop iteration.
+//
+// When a frame does not fit, extra blocks are taken from the heap for that
+// frame only; the next reset() folds them into a single bigger block, so
+// after a few frames steady state does no heap allocation at all.
+class FrameArena {
+public:
+    explicit FrameArena(std::size_t capacity = 64 * 1024){ grow(capacity); }
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(std::size_t bytes, std::size_t align){
+        std::size_t p = (m_used + align - 1) & ~(align - 1);
+        if(p + bytes > m_cap){
+            // Overflow: extra block for this frame only
+            m_overflowBytes += bytes + align;
+            m_overflow.emplace_back(new unsigned char[bytes + align]);
+            void* raw = m_overflow.back().get();
+            std::size_t space = bytes + align;
+            return std::align(align, bytes, raw, space);
+        }
+        m_used = p + bytes;
+        if(m_used > m_peak) m_peak = m_used;
+        return m_block.get() + p;
+    }
+
+    void reset(){
+        if(!m_overflow.empty()){
+            std::size_t want = m_cap + m_overflowBytes;
+            m_overflow.clear();
+            m_overflowBytes = 0;
+            grow(want + want/2);
+        }
+        m_used = 0;
+    }
+
+    std::size_t capacity() const { return m_cap; }
+    std::size_t peak() const { return m_peak; }
+
+private:
+    void grow(std::size_t cap){
+        m_block.reset(new unsigned char[cap]);
+        m_cap = cap;
+    }
+
+    std::unique_ptr<unsigned char[]> m_block;
+    std::size_t m_cap = 0, m_used = 0, m_peak = 0;
+    std::vector<std::unique_ptr<unsigned char[]>> m_overflow;
+    std::size_t m_overflowBytes = 0;
+};
+
+// STL allocator over a FrameArena. Containers using it must not outlive the frame.
+template<class T>
+struct FrameAllocator {
+    using value_type = T;
+
+    FrameArena* arena;
+
+    explicit FrameAllocator(FrameArena& a) noexcept : arena(&a) {}
+    template<class U> FrameAllocator(const FrameAllocator<U>& o) noexcept : arena(o.arena) {}
+
+    T* allocate(std::size_t n){ return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, std::size_t) noexcept {}
+
+    template<class U> bool operator==(const FrameAllocator<U>& o) const noexcept { return arena == o.arena; }
+    template<class U> bool operator!=(const FrameAllocator<U>& o) const noexcept { return arena != o.arena; }
+};
+
+template<class T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
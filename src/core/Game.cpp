@@ -1,27 +1,41 @@
-
 #include "Game.hpp"
 #include "State.hpp"
-#include "../game/PlayState.hpp"
+#include "../game/LoadState.hpp"
+#include <iostream>
 
-Game::Game() : m_window(sf::VideoMode(1280,720), "ArmyMen RTS"){
-    m_window.setFramerateLimit(60);
-    changeState(std::make_unique<PlayState>(*this));
+Game::Game(Mode mode){
+    if(mode == Mode::Headless) return;
+    m_window.emplace(sf::VideoMode(1280,720), "ArmyMen RTS");
+    m_window->setFramerateLimit(60);
+    changeState(std::make_unique<LoadState>(*this));
 }
 void Game::run(){
+    if(!m_window) return;
+    sf::RenderWindow& win = *m_window;
     sf::Clock clk;
-    while(m_window.isOpen()){
+    while(win.isOpen()){
+        if(m_next) m_state = std::move(m_next);
         sf::Event e;
-        while(m_window.pollEvent(e)){
-            if(e.type==sf::Event::Closed) m_window.close();
+        while(win.pollEvent(e)){
+            if(e.type==sf::Event::Closed) win.close();
             if(m_state) m_state->handleEvent(e);
         }
         float dt = clk.restart().asSeconds();
         if(m_state){
             m_state->update(dt);
-            m_window.clear(sf::Color(20,40,20));
-            m_state->render(m_window);
-            m_window.display();
+            win.clear(sf::Color(20,40,20));
+            m_state->render(win);
+            win.display();
+
+            if(!m_firstFrameReported && !m_state->isLoading()){
+                m_firstFrameReported = true;
+                int ms = m_bootClock.getElapsedTime().asMilliseconds();
+                std::cout << "[startup] time-to-first-frame: " << ms << " ms (budget " << kStartupBudgetMs << " ms)"
+                          << (ms > kStartupBudgetMs ? "  ** OVER BUDGET **" : "") << std::endl;
+            }
         }
+        m_frameArena.reset();
     }
 }
-void Game::changeState(std::unique_ptr<State> st){ m_state = std::move(st); }
+// Deferred so a state can request a change from inside its own update()
+void Game::changeState(std::unique_ptr<State> st){ m_next = std::move(st); }
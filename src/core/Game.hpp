@@ -1,16 +1,30 @@
 
 #pragma once
 #include <memory>
+#include <optional>
 #include <SFML/Graphics.hpp>
 #include "State.hpp"
+#include "FrameArena.hpp"
 
 class Game {
 public:
-    Game();
+    // Headless: no window and no initial state; tools (tools/soak) drive a
+    // state themselves and call frameArena().reset() once per frame. No
+    // OpenGL resource is created, so it runs without a display (no DISPLAY/Xvfb)
+    enum class Mode { Windowed, Headless };
+    explicit Game(Mode mode = Mode::Windowed);
     void run();
     void changeState(std::unique_ptr<State> st);
-    sf::RenderWindow& window(){ return m_window; }
+    sf::RenderWindow& window(){ return *m_window; } // Windowed only
+    FrameArena& frameArena(){ return m_frameArena; }
+
+    // Startup budget for the first playable frame (after loading), in ms
+    static constexpr int kStartupBudgetMs = 2000;
 private:
-    sf::RenderWindow m_window;
+    sf::Clock m_bootClock; // declared first: starts before the window is created
+    std::optional<sf::RenderWindow> m_window; // empty when headless: creating it opens the display
     std::unique_ptr<State> m_state;
+    std::unique_ptr<State> m_next;  // applied at the top of the next loop iteration
+    bool m_firstFrameReported{false};
+    FrameArena m_frameArena;
 };
@@ -8,5 +8,6 @@ public:
     virtual void handleEvent(const sf::Event&)=0;
     virtual void update(float)=0;
     virtual void render(sf::RenderWindow&)=0;
+    virtual bool isLoading() const { return false; }
 protected: Game& game;
 };
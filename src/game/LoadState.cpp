@@ -0,0 +1,41 @@
+#include "LoadState.hpp"
+#include "PlayState.hpp"
+#include "../core/Game.hpp"
+#include <iostream>
+
+LoadState::LoadState(Game& g) : State(g), play_(std::make_unique<PlayState>(g)) {
+    barBack_.setSize({400.f, 16.f});
+    barBack_.setFillColor(sf::Color(0,0,0,160));
+    barBack_.setOutlineColor(sf::Color(200,200,200));
+    barBack_.setOutlineThickness(1.f);
+    barFill_.setFillColor(sf::Color(80,220,80));
+
+    PlayState* p = play_.get();
+    loader_.start([p](const AsyncLoader::Progress& progress){ p->loadAsync(progress); });
+}
+
+// Si se cierra la ventana a mitad de carga, espera al hilo antes de soltar el PlayState
+LoadState::~LoadState(){ loader_.join(); }
+
+void LoadState::update(float){
+    if (!loader_.done() || !play_) return;
+    loader_.join();
+
+    for (auto& st : loader_.stages())
+        std::cout << "[carga] " << st.name << ": " << st.ms << " ms\n";
+    std::cout << "[carga] total (hilo de carga): " << loader_.totalMs() << " ms" << std::endl;
+
+    play_->finishLoad(); // recursos de GPU: solo en el hilo principal
+    game.changeState(std::move(play_));
+}
+
+void LoadState::render(sf::RenderWindow& win){
+    win.setView(win.getDefaultView());
+    sf::Vector2f ws = win.getDefaultView().getSize();
+    sf::Vector2f at{ ws.x/2 - 200.f, ws.y/2 - 8.f };
+    barBack_.setPosition(at);
+    barFill_.setPosition(at);
+    barFill_.setSize({400.f * loader_.progress(), 16.f});
+    win.draw(barBack_);
+    win.draw(barFill_);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <memory>
+
+#include <SFML/Graphics.hpp>
+
+#include "../core/State.hpp"
+#include "../core/AsyncLoader.hpp"
+
+class PlayState;
+
+// Pantalla de carga: prepara un PlayState en un hilo aparte (fuente, mapa,
+// geometría de tiles/niebla, mundo inicial) mientras dibuja una barra de
+// progreso; al terminar lo completa en el hilo principal y cambia de estado.
+class LoadState : public State {
+public:
+    explicit LoadState(Game& g);
+    ~LoadState() override;
+
+    void handleEvent(const sf::Event&) override {}
+    void update(float dt) override;
+    void render(sf::RenderWindow&) override;
+    bool isLoading() const override { return true; }
+
+private:
+    std::unique_ptr<PlayState> play_;
+    AsyncLoader                loader_;
+    sf::RectangleShape         barBack_, barFill_;
+};
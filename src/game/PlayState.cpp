@@ -3,6 +3,8 @@
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
 
 // ==================== Helpers locales ====================
 static float vlen(sf::Vector2f v){ return std::sqrt(v.x*v.x + v.y*v.y); }
@@ -15,8 +17,9 @@ static sf::Vector2f worldMouse(sf::RenderWindow& win, const sf::View& cam){
 // mapear mouse (respetando la vista cam)
 
 // offsets para formación (cuadrícula compacta)
-static std::vector<sf::Vector2f> formationOffsets(std::size_t n, float spacing=18.f){
-    std::vector<sf::Vector2f> off;
+// (vive en el arena del frame: no usar después de este frame)
+static FrameVector<sf::Vector2f> formationOffsets(std::size_t n, FrameArena& arena, float spacing=18.f){
+    FrameVector<sf::Vector2f> off{FrameAllocator<sf::Vector2f>(arena)};
     if(n==0) return off;
     std::size_t cols = std::ceil(std::sqrt((float)n));
     std::size_t rows = std::ceil((float)n / (float)cols);
@@ -59,6 +62,17 @@ void PlayState::handleEvent(const sf::Event& e){
         // }
     }
 
+    // Click en el minimapa → saltar la cámara (no inicia selección)
+    if(e.type==sf::Event::MouseButtonPressed && e.mouseButton.button==sf::Mouse::Left){
+        sf::Vector2f w;
+        if(minimap.screenToWorld(win, {e.mouseButton.x,e.mouseButton.y}, w)){
+            cam.setCenter(w);
+            win.setView(cam);
+            minimapClick_ = true; // el release de este click tampoco selecciona
+            return;
+        }
+    }
+
     if(e.type==sf::Event::MouseButtonPressed){
     if(e.mouseButton.button==sf::Mouse::Left){
         dragging_ = true;
@@ -68,21 +82,17 @@ void PlayState::handleEvent(const sf::Event& e){
         // movimiento grupal al punto
         sf::Vector2f tgt = worldMouse(win, cam);
 
-        // junta seleccionados: aliados + bulldozer (si quieres excluir bulldozer, quita su bloque)
-        std::vector<sf::Vector2f*> movers; movers.reserve(allies_.size()+1);
-        for(auto& a : allies_) if(a.alive && a.selected) movers.push_back(&a.target);
-        bool bulldozerSelected = false;
-        if(bulldozer.alive && bulldozer.selected) { bulldozerSelected = true; movers.push_back(&bulldozer.target); }
-
-        if(!movers.empty()){
-            auto off = formationOffsets(movers.size(), 18.f);
-            // asigna destino en formación
-            for(std::size_t i=0;i<movers.size();++i){
-                *(movers[i]) = tgt + off[i];
-            }
-            // activa hasTarget de los verdaderos objetos
-            for(auto& a : allies_) if(a.alive && a.selected){ a.hasTarget = true; }
-            if(bulldozerSelected) { bulldozer.hasTarget = true; }
+        // junta seleccionados: aliados + bulldozers (si quieres excluir bulldozers, quita su bloque).
+        // No se mueve nada aquí: la orden pasa por lockstep y se aplica en su tick (applyCommand)
+        // La lista sale del índice de selección: O(seleccionados), ordenada como pide Command
+        Command c;
+        c.type = CommandType::Move;
+        c.x = (std::int32_t)tgt.x; c.y = (std::int32_t)tgt.y;
+        c.units = selection_.units();
+        std::sort(c.units.begin(), c.units.end());
+
+        if(!c.units.empty()){
+            lockstep_.submit(std::move(c));
         }else{
             // si nadie está seleccionado, mueve el "player" de pruebas como antes
             //if(player.selected){ player.target = tgt; player.hasTarget = true; }
@@ -91,6 +101,7 @@ void PlayState::handleEvent(const sf::Event& e){
 }
 if(e.type==sf::Event::MouseButtonReleased && e.mouseButton.button==sf::Mouse::Left){
     dragging_ = false;
+    if(minimapClick_){ minimapClick_ = false; return; }
     sf::Vector2f end = worldMouse(win, cam);
 
     // ¿drag o click?
@@ -101,38 +112,48 @@ if(e.type==sf::Event::MouseButtonReleased && e.mouseButton.button==sf::Mouse::Le
     bool addMode = sf::Keyboard::isKeyPressed(sf::Keyboard::LShift) || sf::Keyboard::isKeyPressed(sf::Keyboard::RShift);
 
     if(!addMode){
-        // limpia selección previa si no hay Shift
-        for(auto& a : allies_) a.selected = false;
-        bulldozer.selected = false;
+        // limpia selección previa si no hay Shift (solo toca a los seleccionados)
+        clearSelection();
        // player.selected = false; // opcional
     }
 
     if(isClick){
-        // selección por click (elige la unidad más cercana dentro de un radio)
+        // selección por click (la unidad más cercana dentro de un radio; aliados antes que dozers)
         sf::Vector2f w = end;
-        float best = 26.f; // radio de selección
-        Ally* bestAlly = nullptr;
-        for(auto& a : allies_) if(a.alive){
-            float d = vlen(a.pos - w);
-            if(d < best){ best = d; bestAlly = &a; }
-        }
-        if(bestAlly) bestAlly->selected = true;
-        else{
-            // probar bulldozer y player
-            if(vlen(bulldozer.pos - w) < 26.f) bulldozer.selected = true;
-           // else if(vlen(player.pos - w) < 26.f) player.selected = true;
+        const float radius = 26.f; // radio de selección
+        float bestA = radius, bestD = radius;
+        UnitRef hitA = 0, hitD = 0;
+        bool anyA = false, anyD = false;
+        units_.query(sf::FloatRect(w.x - radius, w.y - radius, 2*radius, 2*radius), [&](UnitRef u){
+            float d = vlen(unitPos(u) - w);
+            if(u & kDozerRef){ if(d < bestD){ bestD = d; hitD = u; anyD = true; } }
+            else             { if(d < bestA){ bestA = d; hitA = u; anyA = true; } }
+        });
+        if(anyA || anyD){
+            UnitRef hit = anyA ? hitA : hitD;
+            // doble click sobre una unidad → todas las de su tipo en pantalla
+            bool dbl = clickClock_.getElapsedTime().asSeconds() < kDoubleClickTime && vlen(w - lastClickPos_) < 8.f;
+            if(dbl) selectTypeOnScreen(unitType(hit));
+            else    select(hit);
         }
+        // else if(vlen(player.pos - w) < 26.f) player.selected = true;
+        clickClock_.restart();
+        lastClickPos_ = w;
     }else{
-        // selección por rectángulo (marquee)
-        for(auto& a : allies_){
-            if(a.alive) a.selected = sel.contains(a.pos);
-        }
-        if(bulldozer.alive) bulldozer.selected = sel.contains(bulldozer.pos);
+        // selección por rectángulo (marquee): solo las celdas que toca el rectángulo
+        units_.query(sel, [&](UnitRef u){ if(sel.contains(unitPos(u))) select(u); });
         // player opcional:
         // player.selected = sel.contains(player.pos);
     }
 }
 
+    // Grupos de control: Ctrl+número guarda la selección, número la recupera (Shift: agrega)
+    if (e.type == sf::Event::KeyPressed && e.key.code >= sf::Keyboard::Num0 && e.key.code <= sf::Keyboard::Num9){
+        int g = e.key.code - sf::Keyboard::Num0;
+        if (e.key.control) selection_.storeGroup(g);
+        else               recallGroup(g, e.key.shift);
+    }
+
     // Toggle Fog
     if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::N){
         showFog_ = !showFog_;
@@ -140,106 +161,317 @@ if(e.type==sf::Event::MouseButtonReleased && e.mouseButton.button==sf::Mouse::Le
 
     // Colas de producción: HQ y Garage
     if (e.type==sf::Event::KeyPressed && e.key.code==sf::Keyboard::Q){
-        for (auto& b : buildingsA_) if (b.type == Building::Type::HQ){ b.queue.push_back("Soldier"); break; }
+        submitQueue(Building::Type::HQ, UnitType::Soldier);
     }
     if (e.type==sf::Event::KeyPressed && e.key.code==sf::Keyboard::E){
-        for (auto& b : buildingsA_) if (b.type == Building::Type::Garage){ b.queue.push_back("Tank"); break; }
+        submitQueue(Building::Type::Garage, UnitType::Tank);
     }
     // Extras (opcional): Harvester y Minesweeper
     if (e.type==sf::Event::KeyPressed && e.key.code==sf::Keyboard::H){
-        for (auto& b : buildingsA_) if (b.type == Building::Type::Garage){ b.queue.push_back("Harvester"); break; }
+        submitQueue(Building::Type::Garage, UnitType::Harvester);
     }
     if (e.type==sf::Event::KeyPressed && e.key.code==sf::Keyboard::X){
-        for (auto& b : buildingsA_) if (b.type == Building::Type::HQ){ b.queue.push_back("Minesweeper"); break; }
+        submitQueue(Building::Type::HQ, UnitType::Minesweeper);
+    }
+    if (e.type==sf::Event::KeyPressed && e.key.code==sf::Keyboard::G){
+        submitQueue(Building::Type::Garage, UnitType::Bulldozer);
     }
 
-    // Construcción con Bulldozer (B)
+    // Construcción con Bulldozer (B; Shift+B = prioritario)
     if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::B) {
         sf::Vector2f w = worldMouse(win, cam);
-        bulldozerBuildAttempt(w);
+        Command c;
+        c.type = CommandType::Build;
+        c.x = (std::int32_t)w.x; c.y = (std::int32_t)w.y;
+        c.priority = e.key.shift ? 1 : 0;
+        lockstep_.submit(std::move(c));
     }
 
     // Colocar mina (M)
     if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::M){
         sf::Vector2f w = screenToWorld(win, sf::Mouse::getPosition(win));
-        mines_.push_back({w, 18.f, true});
+        Command c;
+        c.type = CommandType::PlaceMine;
+        c.x = (std::int32_t)w.x; c.y = (std::int32_t)w.y;
+        lockstep_.submit(std::move(c));
     }
 }
 
-// ==================== Update ====================
-void PlayState::update(float dt){
-    auto& win = game.window();
+// ==================== Órdenes (lockstep) ====================
+void PlayState::submitQueue(Building::Type building, UnitType unit){
+    Command c;
+    c.type = CommandType::Queue;
+    c.building = (std::uint8_t)building;
+    c.unit = (std::uint8_t)unit;
+    lockstep_.submit(std::move(c));
+}
 
-    // init once
-    static bool init=false;
-    if(!init){
-        map.generate(32,20);
-        fog.init(map.width(), map.height());
-        cam = win.getDefaultView();
-
-        // Player de pruebas (lo mantenemos por compatibilidad con tu base)
-        // player.pos = {4*64.f+32.f, 4*64.f+32.f};
-        // player.target = player.pos;
-
-        font.loadFromFile("/usr/share/fonts/TTF/DejaVuSans.ttf"); // puede fallar silencioso en otros SO
-        hud.setFont(font); hud.setCharacterSize(16); hud.setFillColor(sf::Color::White);
-
-        // === Recursos (juguetes) ===
-        resources_.push_back({ {600.f, 400.f}, 300.f });
-        resources_.push_back({ {740.f, 520.f}, 300.f });
-
-        // === Edificios base (A) ===
-        buildingsA_.push_back({ Building::Type::HQ,     {200.f,200.f}, {}, 0.f });
-        buildingsA_.push_back({ Building::Type::Garage, {320.f,200.f}, {}, 0.f });
-        buildingsA_.push_back({ Building::Type::Depot,  {260.f,200.f}, {}, 0.f });
-
-        // estilo del rectángulo de selección
-        dragRect_.setFillColor(sf::Color(0,120,255,40));
-        dragRect_.setOutlineColor(sf::Color(0,120,255,200));
-        dragRect_.setOutlineThickness(1.f);
-
-        // === Ejército inicial Equipo A ===
-        // 5 soldados básicos
-        for(int i=0;i<5;i++){
-            Ally s;
-            s.type  = UnitType::Soldier;
-            s.pos   = {220.f + float(i*18), 260.f};
-            s.speed = 110.f;
-            s.color = sf::Color(60,150,70);
-            allies_.push_back(s);
+// Aplica una orden en su tick; igual en todos los peers
+void PlayState::applyCommand(const Command& c){
+    sf::Vector2f p{ (float)c.x, (float)c.y };
+    switch(c.type){
+    case CommandType::Move: {
+        FrameVector<sf::Vector2f*> movers{FrameAllocator<sf::Vector2f*>(game.frameArena())};
+        movers.reserve(c.units.size());
+        for(UnitRef u : c.units){
+            std::uint32_t i = u & ~kDozerRef;
+            if(u & kDozerRef){ if(i<bulldozers_.size() && bulldozers_[i].alive) movers.push_back(&bulldozers_[i].target); }
+            else             { if(i<allies_.size()     && allies_[i].alive)     movers.push_back(&allies_[i].target); }
         }
-        // 2 volquetas (harvesters)
-        for(int i=0;i<2;i++){
-            Ally h;
-            h.type = UnitType::Harvester;
-            h.pos  = {340.f + float(i*20), 260.f};
-            h.speed = 90.f;
-            h.cargo = 0.f; h.cargoCap = 100.f; h.resIdx = -1; h.waiting = false;
-            h.color = sf::Color(220,220,0);
-            allies_.push_back(h);
+        if(movers.empty()) break;
+        auto off = formationOffsets(movers.size(), game.frameArena(), 18.f);
+        // asigna destino en formación
+        for(std::size_t i=0;i<movers.size();++i){
+            *(movers[i]) = p + off[i];
         }
-        // 1 busca-minas
-        {
-            Ally m;
-            m.type = UnitType::Minesweeper;
-            m.pos  = {285.f, 260.f};
-            m.speed= 100.f;
-            m.color= sf::Color(120,200,120);
-            allies_.push_back(m);
+        // activa hasTarget de los verdaderos objetos
+        for(UnitRef u : c.units){
+            std::uint32_t i = u & ~kDozerRef;
+            if(u & kDozerRef){
+                // orden manual: el dozer suelta su trabajo (vuelve a la cola)
+                if(i<bulldozers_.size() && bulldozers_[i].alive){ bulldozers_[i].hasTarget = true; releaseBuildJobs((int)i); }
+            }else if(i<allies_.size() && allies_[i].alive){
+                allies_[i].hasTarget = true; wakeAlly(allies_[i]);
+            }
         }
+        break;
+    }
+    case CommandType::Queue:
+        for (auto& b : buildingsA_) if ((std::uint8_t)b.type == c.building){ b.queue.push_back((UnitType)c.unit); break; }
+        break;
+    case CommandType::Build:
+        bulldozerBuildAttempt(p, c.priority);
+        break;
+    case CommandType::PlaceMine:
+        placeMine(p);
+        break;
+    }
+}
 
-        // === Bulldozer único ===
-        bulldozer.pos   = {180.f, 260.f};
-        bulldozer.type  = UnitType::Bulldozer;
-        bulldozer.speed = 60.f;
-        bulldozer.alive = true;
+// Hash del estado simulado (no de la vista) para detectar desync entre peers.
+// Posiciones y cantidades cuantizadas a 1/16 para no depender del último bit.
+std::uint32_t PlayState::stateHash() const{
+    std::uint32_t h = 2166136261u;
+    auto mix = [&h](std::int32_t v){
+        for(int i=0;i<4;++i){ h ^= (std::uint32_t)(v >> (8*i)) & 0xFFu; h *= 16777619u; }
+    };
+    auto q = [](float f){ return (std::int32_t)std::lround(f*16.f); };
+    mix(plastic_);
+    for (auto& a : allies_){
+        mix(a.alive); if(!a.alive) continue;
+        mix((int)a.type); mix(q(a.pos.x)); mix(q(a.pos.y)); mix(a.hasTarget); mix(q(a.hp)); mix(q(a.cargo));
+    }
+    for (auto& d : bulldozers_){ mix(d.alive); mix(q(d.pos.x)); mix(q(d.pos.y)); }
+    for (auto& m : mines_) mix(m.active);
+    for (auto& r : resources_) mix(q(r.amount));
+    mix((int)buildingsA_.size());
+    for (auto& j : buildJobs_){ mix(j.dozer); mix(q(j.progress)); }
+    return h;
+}
 
-        // Plástico inicial Equipo A
-        plastic_ = 300;
+// ==================== Carga ====================
+// Fuente del HUD: ARMYMEN_FONT si está definida, si no rutas típicas por SO
+static bool loadUiFont(sf::Font& font){
+    if (const char* env = std::getenv("ARMYMEN_FONT"))
+        if (font.loadFromFile(env)) return true;
+    static const char* candidates[] = {
+        "assets/fonts/DejaVuSans.ttf",
+        "/usr/share/fonts/TTF/DejaVuSans.ttf",                 // Arch
+        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",     // Debian/Ubuntu
+        "/usr/share/fonts/dejavu-sans-fonts/DejaVuSans.ttf",   // Fedora
+        "/System/Library/Fonts/Supplemental/Arial.ttf",        // macOS
+        "C:/Windows/Fonts/arial.ttf"                           // Windows
+    };
+    for (const char* path : candidates)
+        if (font.loadFromFile(path)) return true;
+    std::cerr << "[carga] no se encontró fuente para el HUD (usa ARMYMEN_FONT)\n";
+    return false;
+}
 
-        init=true;
+// Red opcional: ARMYMEN_NET="jugador:puertoLocal:hostPeer:puertoPeer" (2 jugadores,
+// ej. "0:40000:127.0.0.1:40001" y "1:40001:127.0.0.1:40000"). Sin la variable: un
+// solo jugador, con las órdenes pasando igual por lockstep.
+void PlayState::setupNetwork(){
+    const char* env = std::getenv("ARMYMEN_NET");
+    if (!env) return;
+    int player=0; unsigned localPort=0, peerPort=0; char host[128]={0};
+    if (std::sscanf(env, "%d:%u:%127[^:]:%u", &player, &localPort, host, &peerPort) != 4 || player<0 || player>1){
+        std::cerr << "[red] ARMYMEN_NET inválida: " << env << "\n";
+        return;
+    }
+    auto udp = std::make_unique<UdpTransport>();
+    if (!udp->open((unsigned short)localPort, host, (unsigned short)peerPort)){
+        std::cerr << "[red] no se pudo abrir UDP " << localPort << " → " << host << ":" << peerPort << "\n";
+        return;
+    }
+    lockstep_ = Lockstep(player, 2);
+    lockstep_.addPeer(1-player, std::move(udp));
+}
+
+void PlayState::connectPeer(int player, std::unique_ptr<Transport> link){
+    lockstep_ = Lockstep(player, 2);
+    lockstep_.addPeer(1-player, std::move(link));
+}
+
+// Trabajo de CPU puro: corre en el hilo de LoadState (sin tocar la ventana ni la GPU)
+void PlayState::loadAsync(const AsyncLoader::Progress& progress){
+    progress(0.0f, "Fuente");
+    loadUiFont(font);
+
+    // ARMYMEN_SCENARIO="preset[,clave=valor...]" reemplaza el mundo fijo (ver Scenario.hpp)
+    if (const char* env = std::getenv("ARMYMEN_SCENARIO")){
+        ScenarioConfig sc;
+        if (parseScenario(env, sc)){
+            progress(0.3f, "Escenario");
+            loadScenario(sc);
+            progress(0.8f, "Red");
+            setupNetwork();
+            return;
+        }
+        std::cerr << "[carga] ARMYMEN_SCENARIO inválido: " << env << " (se usa el mundo fijo)\n";
+    }
+
+    progress(0.3f, "Mapa (tiles + geometría)");
+    map.generate(32,20);
+
+    progress(0.6f, "Niebla (bitplanes + geometría)");
+    fog.init(map, 1); // solo el equipo A tiene unidades; sumar planos cuando exista el B
+    occupancy_.init(map);
+
+    progress(0.7f, "Red");
+    setupNetwork();
+
+    progress(0.8f, "Mundo inicial");
+    // Player de pruebas (lo mantenemos por compatibilidad con tu base)
+    // player.pos = {4*64.f+32.f, 4*64.f+32.f};
+    // player.target = player.pos;
+
+    // === Recursos (juguetes) ===
+    addResource({600.f, 400.f}, 300.f);
+    addResource({740.f, 520.f}, 300.f);
+
+    // === Edificios base (A) ===
+    buildingsA_.push_back({ Building::Type::HQ,     {200.f,200.f}, {}, 0.f });
+    buildingsA_.push_back({ Building::Type::Garage, {320.f,200.f}, {}, 0.f });
+    buildingsA_.push_back({ Building::Type::Depot,  {260.f,200.f}, {}, 0.f });
+    for (auto& b : buildingsA_)
+        occupancy_.set(OccupancyGrid::footprintAt(b.pos, {Building::kSize, Building::kSize}), OccupancyGrid::Building);
+    for (auto& r : resources_)  occupancy_.set(OccupancyGrid::tileOf(r.pos), OccupancyGrid::Resource);
+
+    // === Ejército inicial Equipo A ===
+    // 5 soldados básicos
+    for(int i=0;i<5;i++){
+        Ally s;
+        s.type  = UnitType::Soldier;
+        s.pos   = {220.f + float(i*18), 260.f};
+        s.speed = 110.f;
+        s.color = sf::Color(60,150,70);
+        allies_.push_back(s);
+    }
+    // 2 volquetas (harvesters)
+    for(int i=0;i<2;i++){
+        Ally h;
+        h.type = UnitType::Harvester;
+        h.pos  = {340.f + float(i*20), 260.f};
+        h.speed = 90.f;
+        h.cargo = 0.f; h.cargoCap = 100.f; h.resIdx = -1; h.waiting = false;
+        h.color = sf::Color(220,220,0);
+        allies_.push_back(h);
+    }
+    // 1 busca-minas
+    {
+        Ally m;
+        m.type = UnitType::Minesweeper;
+        m.pos  = {285.f, 260.f};
+        m.speed= 100.f;
+        m.color= sf::Color(120,200,120);
+        allies_.push_back(m);
     }
 
+    // === Bulldozer inicial (más se producen en el Garage con G) ===
+    {
+        Unit d;
+        d.pos   = {180.f, 260.f};
+        d.type  = UnitType::Bulldozer;
+        d.speed = 60.f;
+        d.alive = true;
+        bulldozers_.push_back(d);
+    }
+
+    // Plástico inicial Equipo A
+    plastic_ = 300;
+    indexWorld();
+
+}
+
+// Mundo generado: base en la esquina libre de árboles, el resto al azar (con semilla)
+void PlayState::loadScenario(const ScenarioConfig& cfg){
+    ScenarioRng rng(cfg.seed);
+    map.generate(std::max(cfg.mapW, 8), std::max(cfg.mapH, 8));
+    fog.init(map, 1);
+    occupancy_.init(map);
+    cam = sf::View(sf::FloatRect(0.f, 0.f, 1280.f, 720.f)); // la real la pone finishLoad()
+
+    const sf::Vector2f world = worldSize();
+    auto randomPos = [&]{ return sf::Vector2f{ rng.range(32.f, world.x-32.f), rng.range(32.f, world.y-32.f) }; };
+    auto inBase = [](sf::Vector2i t){ return t.x < 7 && t.y < 6; };
+
+    // === Base (misma disposición que el mundo fijo) ===
+    buildingsA_.push_back({ Building::Type::HQ,     {200.f,200.f}, {}, 0.f });
+    buildingsA_.push_back({ Building::Type::Garage, {320.f,200.f}, {}, 0.f });
+    buildingsA_.push_back({ Building::Type::Depot,  {260.f,200.f}, {}, 0.f });
+    for (auto& b : buildingsA_)
+        occupancy_.set(OccupancyGrid::footprintAt(b.pos, {Building::kSize, Building::kSize}), OccupancyGrid::Building);
+
+    // === Recursos y minas por densidad (por cada 100 tiles) ===
+    const float tiles = (float)map.width() * map.height();
+    const int nRes   = (int)std::lround(cfg.resourceDensity * tiles / 100.f);
+    const int nMines = (int)std::lround(cfg.mineDensity * tiles / 100.f);
+    for (int i=0, tries=0; i<nRes && tries<nRes*8; ++tries){
+        sf::Vector2i t{ rng.below(map.width()), rng.below(map.height()) };
+        if (inBase(t) || !occupancy_.canPlace(t)) continue;
+        addResource(OccupancyGrid::centerOf(t), 300.f);
+        occupancy_.set(t, OccupancyGrid::Resource);
+        ++i;
+    }
+    mines_.reserve(nMines);
+    for (int i=0; i<nMines; ++i){
+        sf::Vector2f p = randomPos();
+        // La base arranca limpia: se corre a la derecha sin salir del mapa
+        // (el mapa tiene al menos 8 tiles de ancho, así que cae en x >= 7)
+        if (inBase(OccupancyGrid::tileOf(p))) p.x = std::min(p.x + 7*64.f, world.x - 32.f);
+        mines_.push_back({ p, 18.f, true });
+    }
+
+    // === Ejército: repartido por el mapa ===
+    auto spawnN = [&](UnitType t, int n){ for (int i=0;i<n;++i) spawnUnit(t, randomPos()); };
+    spawnN(UnitType::Soldier,     cfg.soldiers);
+    spawnN(UnitType::Tank,        cfg.tanks);
+    spawnN(UnitType::Harvester,   cfg.harvesters);
+    spawnN(UnitType::Minesweeper, cfg.minesweepers);
+    spawnN(UnitType::Bulldozer,   cfg.bulldozers);
+
+    plastic_ = cfg.plastic;
+    indexWorld();
+}
+
+// Parte que necesita el hilo principal (texturas, vista de la ventana)
+void PlayState::finishLoad(){
+    auto& win = game.window();
+    cam = win.getDefaultView();
+    hud.setFont(font); hud.setCharacterSize(16); hud.setFillColor(sf::Color::White);
+    minimap.init(map, fog, 0);
+
+    // estilo del rectángulo de selección
+    dragRect_.setFillColor(sf::Color(0,120,255,40));
+    dragRect_.setOutlineColor(sf::Color(0,120,255,200));
+    dragRect_.setOutlineThickness(1.f);
+}
+
+// ==================== Update ====================
+void PlayState::update(float dt){
+    auto& win = game.window();
+
     // WASD camera
     float pan=400.f*dt;
     if(sf::Keyboard::isKeyPressed(sf::Keyboard::W)) cam.move(0,-pan);
@@ -260,13 +492,6 @@ void PlayState::update(float dt){
     //     }
     // }
 
-    // ===== Minas: afectan a todos (player, aliados, bulldozer) =====
-    for (auto& m : mines_) if (m.active) {
-        //if (vlen(player.pos - m.pos) < m.radius){ m.active = false; player.selected=false; }
-        for (auto& a : allies_) if (a.alive && vlen(a.pos - m.pos) < m.radius){ m.active=false; a.alive=false; break; }
-        if (bulldozer.alive && vlen(bulldozer.pos - m.pos) < m.radius){ m.active=false; bulldozer.alive=false; }
-    }
-
     if(dragging_){
         sf::Vector2f cur = worldMouse(win, cam);
         sf::FloatRect rect(
@@ -292,107 +517,118 @@ void PlayState::update(float dt){
         win.draw(dragRect_);
     }
 
-    for(auto& a : allies_){
-        if(!a.alive) continue;
+    stepSimulation(dt);
+    revealFog();
+
+    // ===== Minimapa (solo texels que cambiaron) =====
+    minimap.beginDots();
+    for (auto& a : allies_) if(a.alive) minimap.addDot(a.pos, a.color);
+    for (auto& d : bulldozers_) if(d.alive) minimap.addDot(d.pos, sf::Color(255,140,0));
+    minimap.update();
+
+    // ===== Eventos de minas → destellos =====
+    consumeTriggerEvents(dt);
+
+    // ===== HUD (solo se rearma el texto cuando cambian los números) =====
+    if (plastic_ != hudPlastic_ || (int)allies_.size() != hudAllies_ || lockstep_.desynced() != hudDesync_
+        || minesDetonated_ != hudDetonated_ || minesDefused_ != hudDefused_){
+        hudPlastic_ = plastic_; hudAllies_ = (int)allies_.size(); hudDesync_ = lockstep_.desynced();
+        hudDetonated_ = minesDetonated_; hudDefused_ = minesDefused_;
+        char buf[288];
+        std::snprintf(buf, sizeof(buf),
+            "Plastico: %d | Aliados: %d | Minas: %d detonadas, %d desactivadas%s"
+            "\nQ: Soldier  E: Tank  H: Harvester  X: Minesweeper  G: Bulldozer  |  B: Construir HQ  |  M: Mina  |  N: Fog",
+            hudPlastic_, hudAllies_, hudDetonated_, hudDefused_, hudDesync_ ? " | DESYNC" : "");
+        hud.setString(buf);
+    }
+    hud.setPosition(cam.getCenter().x - cam.getSize().x/2 + 10, cam.getCenter().y - cam.getSize().y/2 + 10);
+}
 
-        // Movimiento por target
-        if(a.hasTarget){
-            sf::Vector2f d = a.target - a.pos;
-            float L = vlen(d);
-            if(L>2.f) a.pos += vnorm(d) * a.speed * dt;
-            else a.hasTarget = false;
-        }
+// Sin ventana: lo mismo que update() menos cámara, input, minimapa y HUD
+void PlayState::stepHeadless(float dt){
+    stepSimulation(dt);
+    revealFog();
+    consumeTriggerEvents(dt);
+}
 
-        // ... (resto de lógicas: Harvester, Minesweeper, etc.)
+// ===== Simulación en ticks fijos (lockstep) =====
+// Solo avanza cuando hay órdenes de todos los jugadores para el tick
+void PlayState::stepSimulation(float dt){
+    lockstep_.pump();
+    simAccum_ = std::min(simAccum_ + dt, kTickDt * kMaxTicksPerFrame);
+    while (simAccum_ >= kTickDt && lockstep_.ready()){
+        for (const Command& c : lockstep_.commands()) applyCommand(c);
+        simulateTick(kTickDt);
+        // El hash recorre todo el mundo: solo se calcula si hay un peer que lo
+        // compare, y cada kHashEvery ticks (los mismos en todos los peers)
+        bool hashed = lockstep_.networked() && lockstep_.tick() % kHashEvery == 0;
+        lockstep_.advance(hashed ? stateHash() : Lockstep::kNoHash);
+        simAccum_ -= kTickDt;
     }
-    if(bulldozer.alive){
-        sf::CircleShape c(6.f);
-        c.setOrigin(6,6);
-        c.setPosition(bulldozer.pos);
-        c.setFillColor(sf::Color(255,140,0));
-        win.draw(c);
+}
 
-        if(bulldozer.selected){
-            sf::CircleShape ring(12.f); ring.setOrigin(12,12);
-            ring.setPosition(bulldozer.pos);
-            ring.setFillColor(sf::Color::Transparent);
-            ring.setOutlineColor(sf::Color::White);
-            ring.setOutlineThickness(1.f);
-            win.draw(ring);
+// ===== Fog of War =====
+void PlayState::revealFog(){
+    fog.clear();
+    if (showFog_) {
+        // Revela player + aliados
+        //fog.revealCircle(player.pos, 160.f);
+        for (auto& a : allies_) if(a.alive){
+            fog.revealCircle(a.pos, 140.f);
         }
+        for (auto& d : bulldozers_) if(d.alive) fog.revealCircle(d.pos, 140.f);
+    } else {
+        // Mostrar todo
+        fog.revealAll();
     }
+}
 
-    // ===== Aliados: mover y comportamientos =====
-    auto nearestResource = [&](sf::Vector2f p)->int{
-        int idx=-1; float best=1e9f;
-        for(int i=0;i<(int)resources_.size();++i){
-            if(resources_[i].amount<=0) continue;
-            float d = vlen(resources_[i].pos - p);
-            if(d<best){ best=d; idx=i; }
-        }
-        return idx;
-    };
-    auto depotPos = [&]()->sf::Vector2f{
-        for(auto& b: buildingsA_) if(b.type==Building::Type::Depot) return b.pos;
-        return sf::Vector2f{260.f,200.f};
-    };
-
-    for(auto& a : allies_){
-        if(!a.alive) continue;
-
-        // Movimiento por target si lo hay
-        if(a.hasTarget){
-            sf::Vector2f d = a.target - a.pos;
-            float L = vlen(d);
-            if(L>2.f){ a.pos += vnorm(d) * a.speed * dt; }
-            else { a.hasTarget = false; }
-        }
+PlayState::WorldStats PlayState::stats() const{
+    WorldStats st;
+    st.allySlots = (int)allies_.size();
+    for (auto& a : allies_)      st.allies += a.alive;
+    for (auto& d : bulldozers_)  st.dozers += d.alive;
+    for (auto& m : mines_)       st.mines  += m.active;
+    for (auto& r : resources_)   st.resources += r.amount > 0.f;
+    st.buildings = (int)buildingsA_.size();
+    st.buildJobs = (int)buildJobs_.size();
+    st.plastic   = plastic_;
+    st.tick      = lockstep_.tick();
+    st.netBytes  = lockstep_.bytesSent();
+    st.netPackets = lockstep_.packetsSent();
+    return st;
+}
 
-        // Comportamientos por tipo
-        if(a.type == UnitType::Harvester){
-            // 1) asignación/validación de recurso
-            if(a.resIdx==-1 || resources_[a.resIdx].amount<=0){
-                a.resIdx = nearestResource(a.pos);
-                if(a.resIdx==-1){
-                    if(a.cargo<=0.f){ a.waiting = true; continue; } // sin recurso y vacío → idle
-                    a.target = depotPos(); a.hasTarget = true; a.waiting=false; // lleva carga → vuelve
-                    continue;
-                }
-            }
-            // 2) lleno → ir a depósito
-            if(a.cargo >= a.cargoCap - 1e-3f){
-                a.target = depotPos(); a.hasTarget = true; a.waiting=false;
-                if(vlen(a.pos - a.target) < 16.f){
-                    plastic_ += (int)a.cargo;
-                    a.cargo = 0.f;
-                    a.hasTarget=false;
-                }
-                continue;
-            }
-            // 3) ir al recurso o recolectar
-            sf::Vector2f rpos = resources_[a.resIdx].pos;
-            if(vlen(a.pos - rpos) > 14.f){
-                a.target = rpos; a.hasTarget = true; a.waiting=false;
-            }else{
-                float mineRate = 40.f; // plástico/seg
-                float take = std::min({mineRate*dt, a.cargoCap - a.cargo, resources_[a.resIdx].amount});
-                a.cargo += take;
-                resources_[a.resIdx].amount -= take;
-                if(resources_[a.resIdx].amount <= 0.f){ resources_[a.resIdx].amount = 0.f; a.resIdx = -1; }
-            }
-            if(nearestResource(a.pos)==-1 && a.cargo<=0.f){ a.waiting=true; }
-        }
-        else if(a.type == UnitType::Minesweeper){
-            float detectR = 42.f; // radio de detección
-            for(auto& m : mines_) if(m.active){
-                if(vlen(a.pos - m.pos) < detectR){ m.active = false; break; }
-            }
-        }
-        else if(a.type == UnitType::Soldier){
-            // FUTURO: disparo en línea recta
-        }
-        else if(a.type == UnitType::Tank){
-            // FUTURO: lógica tanque
+// ==================== Simulación (un tick) ====================
+void PlayState::simulateTick(float dt){
+    // ===== Aliados: mover y comportamientos (con LOD) =====
+    // Cerca de la cámara (o seleccionados) → cada tick. Lejos → cada kLodStride
+    // ticks, por turnos (i+tick), con el dt acumulado para que el resultado
+    // sea el mismo. Dormidos → nada hasta que un evento los despierte (wakeAlly).
+    // En red la cámara y la selección son locales: ahí todo lo despierto va cada tick.
+    const unsigned tick = lockstep_.tick();
+    const bool lodByCamera = !lockstep_.networked();
+    sf::FloatRect nearRect(cam.getCenter().x - cam.getSize().x/2 - kLodMargin,
+                           cam.getCenter().y - cam.getSize().y/2 - kLodMargin,
+                           cam.getSize().x + 2*kLodMargin, cam.getSize().y + 2*kLodMargin);
+    for(std::size_t i=0;i<allies_.size();++i){
+        Ally& a = allies_[i];
+        if(!a.alive || a.sleeping) continue;
+        a.lodDt += dt;
+        bool near = !lodByCamera || a.selected || nearRect.contains(a.pos);
+        if(!near && (i + tick) % kLodStride != 0) continue;
+        float step = a.lodDt;
+        a.lodDt = 0.f;
+        sf::Vector2f before = a.pos;
+        updateAlly(a, step);
+        if(a.pos != before) onUnitMoved(allyRef((std::uint32_t)i), a.pos, a.type==UnitType::Minesweeper);
+
+        // Sin orden ni trabajo → a dormir. Una volqueta que espera recurso queda
+        // anotada para que onEconomyChanged() la despierte
+        bool idle = !a.hasTarget && (a.type!=UnitType::Harvester || a.waiting);
+        if(idle){
+            a.sleeping = true;
+            if(a.type==UnitType::Harvester) waitingHarvesters_.push_back((std::uint32_t)i);
         }
     }
 
@@ -403,61 +639,273 @@ void PlayState::update(float dt){
         else b.buildTimer -= dt;
 
         if (b.buildTimer <= 0.f){
-            std::string item = b.queue.front(); b.queue.erase(b.queue.begin());
+            UnitType item = b.queue.front(); b.queue.erase(b.queue.begin());
             auto spawnAt = b.pos + sf::Vector2f(0,40);
 
-            if (item == "Soldier"){
-                if (plastic_ >= costs_["Soldier"]){
-                    plastic_ -= costs_["Soldier"];
-                    Ally s; s.type=UnitType::Soldier; s.pos=spawnAt; s.speed=110.f; s.color=sf::Color(60,150,70);
-                    allies_.push_back(s);
-                }
-            } else if (item == "Tank"){
-                if (plastic_ >= costs_["Tank"]){
-                    plastic_ -= costs_["Tank"];
-                    Ally t; t.type=UnitType::Tank; t.pos=spawnAt; t.speed=80.f; t.hp=250.f; t.color=sf::Color(30,100,40);
-                    allies_.push_back(t);
-                }
-            } else if (item == "Harvester"){
-                if (plastic_ >= costs_["Harvester"]){
-                    plastic_ -= costs_["Harvester"];
-                    Ally h; h.type=UnitType::Harvester; h.pos=spawnAt; h.speed=90.f; h.cargo=0.f; h.cargoCap=100.f; h.color=sf::Color(220,220,0);
-                    allies_.push_back(h);
-                }
-            } else if (item == "Minesweeper"){
-                if (plastic_ >= costs_["Minesweeper"]){
-                    plastic_ -= costs_["Minesweeper"];
-                    Ally m; m.type=UnitType::Minesweeper; m.pos=spawnAt; m.speed=100.f; m.color=sf::Color(120,200,120);
-                    allies_.push_back(m);
-                }
+            const char* name = item==UnitType::Soldier ? "Soldier" : item==UnitType::Tank ? "Tank"
+                             : item==UnitType::Harvester ? "Harvester" : item==UnitType::Minesweeper ? "Minesweeper"
+                             : "Bulldozer";
+            if (plastic_ >= costs_[name]){
+                plastic_ -= costs_[name];
+                spawnUnit(item, spawnAt);
             }
         }
     }
 
     // ===== Construcción (bulldozer) =====
+    // (como con los aliados: solo se prueban contra minas los dozers que se movieron)
+    FrameVector<sf::Vector2f> dozerBefore{FrameAllocator<sf::Vector2f>(game.frameArena())};
+    dozerBefore.reserve(bulldozers_.size());
+    for (auto& d : bulldozers_) dozerBefore.push_back(d.pos);
     updateBuildJobs(dt);
+    for (std::size_t i=0;i<bulldozers_.size();++i)
+        if (bulldozers_[i].alive && bulldozers_[i].pos != dozerBefore[i])
+            onUnitMoved(dozerRef((std::uint32_t)i), bulldozers_[i].pos, false);
 
-    // ===== Fog of War =====
-    fog.clear();
-    if (showFog_) {
-        // Revela player + aliados
-        //fog.revealCircle(player.pos, 160.f);
-        for (auto& a : allies_) if(a.alive){
-            fog.revealCircle(a.pos, 140.f);
-        }
-        if(bulldozer.alive) fog.revealCircle(bulldozer.pos, 140.f);
-    } else {
-        // Mostrar todo
-        fog.revealCircle({map.width()*32.f, map.height()*32.f}, 10000.f);
+    // ===== Minas: lo que dispararon los movimientos de este tick =====
+    applyTriggerEvents();
+}
+
+// ==================== Selección ====================
+sf::Vector2f PlayState::unitPos(UnitRef u) const{
+    std::uint32_t i = u & ~kDozerRef;
+    return (u & kDozerRef) ? bulldozers_[i].pos : allies_[i].pos;
+}
+
+UnitType PlayState::unitType(UnitRef u) const{
+    return (u & kDozerRef) ? UnitType::Bulldozer : allies_[u].type;
+}
+
+// Índice y flag `selected` siempre juntos
+void PlayState::select(UnitRef u){
+    std::uint32_t i = u & ~kDozerRef;
+    if(u & kDozerRef){ if(i>=bulldozers_.size() || !bulldozers_[i].alive) return; bulldozers_[i].selected = true; }
+    else             { if(i>=allies_.size()     || !allies_[i].alive)     return; allies_[i].selected = true; }
+    selection_.add(u);
+}
+
+void PlayState::deselect(UnitRef u){
+    if(!selection_.remove(u)) return;
+    std::uint32_t i = u & ~kDozerRef;
+    if(u & kDozerRef) bulldozers_[i].selected = false;
+    else              allies_[i].selected = false;
+}
+
+void PlayState::clearSelection(){
+    selection_.clear([this](UnitRef u){
+        std::uint32_t i = u & ~kDozerRef;
+        if(u & kDozerRef) bulldozers_[i].selected = false;
+        else              allies_[i].selected = false;
+    });
+}
+
+// Todas las unidades vivas de un tipo dentro de la vista (consulta a units_)
+void PlayState::selectTypeOnScreen(UnitType type){
+    sf::FloatRect view(cam.getCenter().x - cam.getSize().x/2, cam.getCenter().y - cam.getSize().y/2,
+                       cam.getSize().x, cam.getSize().y);
+    units_.query(view, [&](UnitRef u){
+        if(unitType(u) == type && view.contains(unitPos(u))) select(u);
+    });
+}
+
+// Recupera un grupo; de paso saca del grupo a los muertos
+void PlayState::recallGroup(int g, bool add){
+    if(!add) clearSelection();
+    auto& grp = selection_.group(g);
+    grp.erase(std::remove_if(grp.begin(), grp.end(), [this](UnitRef u){
+        std::uint32_t i = u & ~kDozerRef;
+        return (u & kDozerRef) ? !bulldozers_[i].alive : !allies_[i].alive;
+    }), grp.end());
+    for(UnitRef u : grp) select(u);
+}
+
+// ==================== Minas (triggers) ====================
+// Índices de unidades y minas; se llama al terminar de armar el mundo
+void PlayState::indexWorld(){
+    // Terreno cambiado (dozer talando) → stamps de visión y texel del minimapa
+    map.setOnTileChanged([this](int gx, int gy){
+        fog.onTileChanged(gx, gy);
+        minimap.invalidateTile(gx, gy);
+    });
+    sf::Vector2f world = worldSize();
+    units_.init(world.x, world.y);
+    triggers_.init(world.x, world.y);
+    eventsApplied_ = 0;
+    for (std::size_t i=0;i<allies_.size();++i)      if (allies_[i].alive)      units_.place(allyRef((std::uint32_t)i), allies_[i].pos);
+    for (std::size_t i=0;i<bulldozers_.size();++i)  if (bulldozers_[i].alive)  units_.place(dozerRef((std::uint32_t)i), bulldozers_[i].pos);
+    for (std::size_t i=0;i<mines_.size();++i)       if (mines_[i].active)      triggers_.addMine((int)i, mines_[i].pos, mines_[i].radius);
+}
+
+void PlayState::placeMine(sf::Vector2f p){
+    int idx = (int)mines_.size();
+    mines_.push_back({p, 18.f, true});
+    triggers_.addMine(idx, p, 18.f);
+
+    // Unidades que ya están en rango (pueden estar quietas o dormidas)
+    const float r = TriggerSystem::kDetectRadius;
+    units_.query(sf::FloatRect(p.x - r, p.y - r, 2*r, 2*r), [&](UnitRef u){
+        if (!triggers_.armed(idx)) return;
+        std::uint32_t i = u & ~kDozerRef;
+        if (u & kDozerRef) triggers_.test(u, bulldozers_[i].pos, false);
+        else               triggers_.test(u, allies_[i].pos, allies_[i].type==UnitType::Minesweeper);
+    });
+}
+
+void PlayState::onUnitMoved(UnitRef u, sf::Vector2f pos, bool sweeper){
+    units_.place(u, pos);            // solo toca buckets si cambió de celda
+    triggers_.test(u, pos, sweeper); // celda sin minas → nada
+}
+
+void PlayState::killUnit(UnitRef u){
+    deselect(u);
+    std::uint32_t i = u & ~kDozerRef;
+    if (u & kDozerRef){ if (i<bulldozers_.size()) bulldozers_[i].alive = false; } // su trabajo se libera en updateBuildJobs
+    else if (i<allies_.size()) allies_[i].alive = false;
+    units_.remove(u);
+}
+
+// Consumidor de simulación: aplica los eventos nuevos (igual en todos los peers)
+void PlayState::applyTriggerEvents(){
+    const auto& events = triggers_.events();
+    for (; eventsApplied_ < events.size(); ++eventsApplied_){
+        const TriggerEvent& e = events[eventsApplied_];
+        mines_[e.mine].active = false;
+        if (e.type == TriggerEvent::Type::Defused){ ++minesDefused_; continue; }
+
+        ++minesDetonated_;
+        killUnit(e.unit);
+        // IA: busca-minas ociosos cercanos van a barrer la zona (suele haber más)
+        const float r = 256.f;
+        units_.query(sf::FloatRect(e.pos.x - r, e.pos.y - r, 2*r, 2*r), [&](UnitRef u){
+            if (u & kDozerRef) return;
+            Ally& a = allies_[u];
+            if (a.type != UnitType::Minesweeper || a.hasTarget || vlen(a.pos - e.pos) > r) return;
+            a.target = e.pos; a.hasTarget = true; wakeAlly(a);
+        });
+    }
+}
+
+// Consumidores de vista (destellos + HUD); después se vacía la cola del frame
+void PlayState::consumeTriggerEvents(float dt){
+    for (const TriggerEvent& e : triggers_.events()){
+        bool boom = e.type == TriggerEvent::Type::Detonated;
+        flashes_.push_back({ e.pos, 0.f, boom ? sf::Color(255,150,40) : sf::Color(120,220,255) });
     }
+    for (auto& f : flashes_) f.t += dt;
+    flashes_.erase(std::remove_if(flashes_.begin(), flashes_.end(), [](const Flash& f){ return f.t >= kFlashTime; }), flashes_.end());
+    triggers_.clearEvents();
+    eventsApplied_ = 0;
+}
 
-    // ===== HUD =====
-    hud.setString(
-        "Plastico: " + std::to_string(plastic_) +
-        " | Aliados: " + std::to_string((int)allies_.size()) +
-        "\nQ: Soldier  E: Tank  H: Harvester  X: Minesweeper  |  B: Construir HQ  |  M: Mina  |  N: Fog"
-    );
-    hud.setPosition(cam.getCenter().x - cam.getSize().x/2 + 10, cam.getCenter().y - cam.getSize().y/2 + 10);
+// ==================== Aliados ====================
+// Stats por tipo (producción y escenarios); el Bulldozer va a bulldozers_
+void PlayState::spawnUnit(UnitType type, sf::Vector2f pos){
+    if (type == UnitType::Bulldozer){
+        Unit d; d.type=UnitType::Bulldozer; d.pos=pos; d.speed=60.f;
+        bulldozers_.push_back(d);
+        units_.place(dozerRef((std::uint32_t)bulldozers_.size()-1), pos);
+        return;
+    }
+    Ally a; a.type=type; a.pos=pos;
+    switch (type){
+    case UnitType::Tank:        a.speed=80.f;  a.hp=250.f; a.color=sf::Color(30,100,40); break;
+    case UnitType::Harvester:   a.speed=90.f;  a.cargo=0.f; a.cargoCap=100.f; a.color=sf::Color(220,220,0); break;
+    case UnitType::Minesweeper: a.speed=100.f; a.color=sf::Color(120,200,120); break;
+    default:                    a.speed=110.f; a.color=sf::Color(60,150,70); break;
+    }
+    allies_.push_back(a);
+    units_.place(allyRef((std::uint32_t)allies_.size()-1), pos);
+}
+
+int PlayState::nearestResource(sf::Vector2f p) const{
+    int idx=-1; float best=1e9f;
+    for(int i=0;i<(int)resources_.size();++i){
+        if(resources_[i].amount<=0) continue;
+        float d = vlen(resources_[i].pos - p);
+        if(d<best){ best=d; idx=i; }
+    }
+    return idx;
+}
+
+sf::Vector2f PlayState::depotPos() const{
+    for(auto& b: buildingsA_) if(b.type==Building::Type::Depot) return b.pos;
+    return sf::Vector2f{260.f,200.f};
+}
+
+// Solo un aliado dormido pierde su lodDt (el tiempo dormido no cuenta); uno
+// despierto a mitad de stride conserva lo acumulado
+void PlayState::wakeAlly(Ally& a){
+    if(a.sleeping){ a.sleeping = false; a.lodDt = 0.f; }
+}
+
+void PlayState::addResource(sf::Vector2f pos, float amount){
+    resources_.push_back({ pos, amount });
+    onEconomyChanged();
+}
+
+// O(volquetas en espera): cada una vuelve a buscar recurso/depósito en su próximo tick;
+// si sigue sin nada se vuelve a dormir y a anotar
+void PlayState::onEconomyChanged(){
+    for(std::uint32_t i : waitingHarvesters_){
+        Ally& a = allies_[i];
+        if(a.alive && a.sleeping && a.waiting) wakeAlly(a);
+    }
+    waitingHarvesters_.clear();
+}
+
+// Un paso de simulación de un aliado; dt puede ser de varios frames (LOD)
+void PlayState::updateAlly(Ally& a, float dt){
+    // Movimiento por target si lo hay (sin pasarse cuando dt es grande)
+    if(a.hasTarget){
+        sf::Vector2f d = a.target - a.pos;
+        float L = vlen(d);
+        if(L>2.f){ a.pos += vnorm(d) * std::min(a.speed * dt, L); }
+        else { a.hasTarget = false; }
+    }
+
+    // Comportamientos por tipo
+    if(a.type == UnitType::Harvester){
+        // 1) asignación/validación de recurso
+        if(a.resIdx==-1 || resources_[a.resIdx].amount<=0){
+            a.resIdx = nearestResource(a.pos);
+            if(a.resIdx==-1){
+                if(a.cargo<=0.f){ a.waiting = true; return; } // sin recurso y vacío → idle
+                a.target = depotPos(); a.hasTarget = true; a.waiting=false; // lleva carga → vuelve
+                return;
+            }
+        }
+        // 2) lleno → ir a depósito
+        if(a.cargo >= a.cargoCap - 1e-3f){
+            a.target = depotPos(); a.hasTarget = true; a.waiting=false;
+            if(vlen(a.pos - a.target) < 16.f){
+                plastic_ += (int)a.cargo;
+                a.cargo = 0.f;
+                a.hasTarget=false;
+            }
+            return;
+        }
+        // 3) ir al recurso o recolectar
+        sf::Vector2f rpos = resources_[a.resIdx].pos;
+        if(vlen(a.pos - rpos) > 14.f){
+            a.target = rpos; a.hasTarget = true; a.waiting=false;
+        }else{
+            float mineRate = 40.f; // plástico/seg
+            float take = std::min({mineRate*dt, a.cargoCap - a.cargo, resources_[a.resIdx].amount});
+            a.cargo += take;
+            resources_[a.resIdx].amount -= take;
+            if(resources_[a.resIdx].amount <= 0.f){ resources_[a.resIdx].amount = 0.f; a.resIdx = -1; }
+        }
+        if(nearestResource(a.pos)==-1 && a.cargo<=0.f){ a.waiting=true; }
+    }
+    else if(a.type == UnitType::Minesweeper){
+        // La detección la hace triggers_ cuando se mueve (ver onUnitMoved)
+    }
+    else if(a.type == UnitType::Soldier){
+        // FUTURO: disparo en línea recta
+    }
+    else if(a.type == UnitType::Tank){
+        // FUTURO: lógica tanque
+    }
 }
 
 // ==================== Proyección pantalla→mundo ====================
@@ -484,16 +932,26 @@ void PlayState::render(sf::RenderWindow& win){
 
     // Minas activas
     for (auto& m : mines_) if (m.active) {
-        sf::CircleShape c(m.radius);
-        c.setOrigin(m.radius, m.radius);
+        sf::CircleShape& c = circleShape(m.radius);
         c.setFillColor(sf::Color(120,60,60));
         c.setPosition(m.pos);
         win.draw(c);
     }
 
+    // Destellos de minas detonadas/desactivadas (anillo que crece y se apaga)
+    for (auto& f : flashes_){
+        float k = f.t / kFlashTime;
+        sf::CircleShape& ring = ringShape(18.f + 42.f*k);
+        sf::Color c = f.color; c.a = (sf::Uint8)(255*(1.f-k));
+        ring.setOutlineColor(c);
+        ring.setOutlineThickness(3.f);
+        ring.setPosition(f.pos);
+        win.draw(ring);
+    }
+
     // Recursos (juguetes)
     for (auto& r : resources_){
-        sf::CircleShape c(8.f); c.setOrigin(8,8);
+        sf::CircleShape& c = circleShape(8.f);
         c.setFillColor(sf::Color(200,180,0));
         c.setPosition(r.pos);
         win.draw(c);
@@ -501,8 +959,7 @@ void PlayState::render(sf::RenderWindow& win){
 
     // Edificios existentes
     for (auto& b : buildingsA_){
-        sf::RectangleShape s({40,40});
-        s.setOrigin(20,20);
+        sf::RectangleShape& s = rectShape({Building::kSize, Building::kSize}, {Building::kSize/2, Building::kSize/2});
         s.setPosition(b.pos);
         s.setFillColor(
             b.type==Building::Type::HQ     ? sf::Color(120,160,120) :
@@ -516,119 +973,221 @@ void PlayState::render(sf::RenderWindow& win){
     // Trabajos de construcción (fantasma + barra)
     drawBuildJobs(win);
 
-    // Bulldozer (si lo mantienes fuera de allies_)
-    if(bulldozer.alive){
-        sf::CircleShape c(6.f);
-        c.setOrigin(6,6);
-        c.setPosition(bulldozer.pos);
+    // Bulldozers (fuera de allies_)
+    for (auto& d : bulldozers_) if(d.alive){
+        sf::CircleShape& c = circleShape(6.f);
+        c.setPosition(d.pos);
         c.setFillColor(sf::Color(255,140,0));
         win.draw(c);
+
+        if(d.selected){
+            sf::CircleShape& ring = ringShape(12.f);
+            ring.setPosition(d.pos);
+            win.draw(ring);
+        }
     }
 
     // Aliados (Equipo A)
     for (auto& a : allies_) if(a.alive){
-        sf::CircleShape c(8.f); c.setOrigin(8,8);
+        sf::CircleShape& c = circleShape(8.f);
         c.setPosition(a.pos);
         c.setFillColor(a.color);
         win.draw(c);
 
         if(a.selected){
-            sf::CircleShape ring(12.f); ring.setOrigin(12,12);
+            sf::CircleShape& ring = ringShape(12.f);
             ring.setPosition(a.pos);
-            ring.setFillColor(sf::Color::Transparent);
-            ring.setOutlineColor(sf::Color::White);
-            ring.setOutlineThickness(1.f);
             win.draw(ring);
         }
         // Indicador de carga de Harvester
         if(a.type==UnitType::Harvester){
             float r = (a.cargo/a.cargoCap);
-            sf::RectangleShape back({18,3}); back.setOrigin(9,14); back.setPosition(a.pos);
+            sf::RectangleShape& back = rectShape({18,3}, {9,14}); back.setPosition(a.pos);
             back.setFillColor(sf::Color(0,0,0,160)); win.draw(back);
-            sf::RectangleShape fill({18*r,2}); fill.setOrigin(9,14); fill.setPosition(a.pos);
+            sf::RectangleShape& fill = rectShape({18*r,2}, {9,14}); fill.setPosition(a.pos);
             fill.setFillColor(sf::Color(240,240,90)); win.draw(fill);
         }
     }
 
     // HUD
     win.draw(hud);
+
+    // Minimapa (esquina inferior derecha)
+    minimap.draw(win, cam);
 }
 
 // ==================== Construcción con Bulldozer ====================
-void PlayState::bulldozerBuildAttempt(const sf::Vector2f& pos) {
-    // Debe existir un bulldozer vivo
-    if (!(bulldozer.alive && bulldozer.type == UnitType::Bulldozer)) return;
+void PlayState::bulldozerBuildAttempt(const sf::Vector2f& pos, int priority) {
+    // Debe existir al menos un bulldozer vivo
+    bool anyDozer = false;
+    for (auto& d : bulldozers_) if (d.alive){ anyDozer = true; break; }
+    if (!anyDozer) return;
+
+    // Se construye con la esquina en el tile bajo el cursor; la huella debe estar
+    // libre (sin edificio, recurso ni otro trabajo reservado). Los árboles no
+    // impiden: el dozer los tala primero
+    const sf::IntRect area = OccupancyGrid::footprint(OccupancyGrid::tileOf(pos), {Building::kSize, Building::kSize});
+    if (!occupancy_.canPlace(area, true)) return;
 
     // Tipo por defecto: HQ (podremos elegir por UI en iteración siguiente)
     const int cost = costs_.count("HQ") ? costs_["HQ"] : 50;
     if (plastic_ < cost) return; // no hay recursos, no crear job
 
-    // Reserva el costo al crear el job (evita doble gasto si se cancela)
+    // Reserva el costo y la huella al crear el job (evita doble gasto / solapes)
     plastic_ -= cost;
+    occupancy_.set(area, OccupancyGrid::Reserved);
+
+    bool trees = false;
+    for (int y=area.top; y<area.top+area.height; ++y)
+        for (int x=area.left; x<area.left+area.width; ++x)
+            trees = trees || map.tileAt(x,y)==TileMap::Tree;
 
-    // Crea un trabajo de construcción
+    // Crea un trabajo de construcción (queda en cola hasta que se asigne un dozer)
     BuildJob job;
     job.type      = Building::Type::HQ;
-    job.target    = pos;
-    job.buildTime = 2.0f;   // placeholder
+    job.area      = area;
+    job.target    = OccupancyGrid::centerOf(area);
+    job.clearTime = trees ? 1.5f : 0.f;
+    job.buildTime = 2.0f + job.clearTime;   // placeholder
     job.progress  = 0.f;
-    job.active    = true;
+    job.priority  = priority;
+    job.dozer     = -1;
     job.started   = false;
     buildJobs_.push_back(job);
 }
 
+// Asigna trabajos en cola a bulldozers libres: primero por prioridad, luego
+// al dozer libre más cercano. Un dozer con orden manual (hasTarget) no cuenta como libre.
+void PlayState::assignBuildJobs(){
+    dozerBusy_.assign(bulldozers_.size(), 0);
+    bool pending = false;
+    for (auto& job : buildJobs_){
+        if (job.dozer >= 0) dozerBusy_[job.dozer] = 1;
+        else pending = true;
+    }
+    if (!pending) return;
+
+    for (;;){
+        // trabajo en cola más prioritario (a igual prioridad, el más antiguo)
+        BuildJob* next = nullptr;
+        for (auto& job : buildJobs_)
+            if (job.dozer < 0 && (!next || job.priority > next->priority)) next = &job;
+        if (!next) return;
+
+        int best = -1; float bestD = 1e9f;
+        for (int i=0;i<(int)bulldozers_.size();++i){
+            const Unit& d = bulldozers_[i];
+            if (!d.alive || d.hasTarget || dozerBusy_[i]) continue;
+            float dist = vlen(d.pos - next->target);
+            if (dist < bestD){ bestD = dist; best = i; }
+        }
+        if (best < 0) return; // no quedan dozers libres
+        next->dozer = best;
+        dozerBusy_[best] = 1;
+    }
+}
+
+// Devuelve a la cola los trabajos de un dozer (orden manual o muerte)
+void PlayState::releaseBuildJobs(int dozer){
+    for (auto& job : buildJobs_)
+        if (job.dozer == dozer){ job.dozer = -1; job.started = false; }
+}
+
 void PlayState::updateBuildJobs(float dt){
-    if (!(bulldozer.alive && bulldozer.type == UnitType::Bulldozer)) return;
     const float arriveRadius = 14.f;
 
+    for (int i=0;i<(int)bulldozers_.size();++i)
+        if (!bulldozers_[i].alive) releaseBuildJobs(i);
+    assignBuildJobs();
+
     for (auto& job : buildJobs_){
-        if (!job.active) continue;
+        if (job.dozer < 0) continue;
+        Unit& dozer = bulldozers_[job.dozer];
 
         if (!job.started){
-            // Mover el dozer hacia el punto objetivo
-            sf::Vector2f dir = vnorm(job.target - bulldozer.pos);
-            bulldozer.vel = dir * bulldozer.speed;
-            bulldozer.pos += bulldozer.vel * dt;
-            bulldozer.vel *= 0.9f;
+            // Mover el dozer asignado hacia el punto objetivo
+            sf::Vector2f dir = vnorm(job.target - dozer.pos);
+            dozer.vel = dir * dozer.speed;
+            dozer.pos += dozer.vel * dt;
+            dozer.vel *= 0.9f;
 
-            if (vlen(job.target - bulldozer.pos) < arriveRadius){
+            if (vlen(job.target - dozer.pos) < arriveRadius){
                 job.started = true; // llegó, comienza la obra
             }
         } else {
-            // Construyendo
+            // Construyendo (antes, talar: setTile avisa a la niebla y al minimapa)
             job.progress += dt;
+            if (job.clearTime > 0.f && job.progress >= job.clearTime){
+                for (int y=job.area.top; y<job.area.top+job.area.height; ++y)
+                    for (int x=job.area.left; x<job.area.left+job.area.width; ++x)
+                        if (map.tileAt(x,y)==TileMap::Tree) map.setTile(x, y, TileMap::Grass);
+                job.clearTime = 0.f;
+            }
             if (job.progress >= job.buildTime){
-                // Spawn del edificio terminado
+                // Spawn del edificio terminado; la huella pasa de reservada a ocupada
                 buildingsA_.push_back({ job.type, job.target, {}, 0.f });
-                job.active = false;
+                occupancy_.set(job.area, OccupancyGrid::Building);
+                job.dozer = -2; // marcado para compactar
+                onEconomyChanged(); // p.ej. un Depot nuevo cambia a dónde descargar
             }
         }
     }
+    // Compacta los trabajos terminados
+    buildJobs_.erase(std::remove_if(buildJobs_.begin(), buildJobs_.end(),
+                                    [](const BuildJob& j){ return j.dozer == -2; }),
+                     buildJobs_.end());
+
+    // Dozers sin trabajo: movimiento por orden manual
+    for (auto& d : bulldozers_){
+        if (!d.alive || !d.hasTarget) continue;
+        sf::Vector2f delta = d.target - d.pos;
+        float L = vlen(delta);
+        if (L>2.f) d.pos += vnorm(delta) * d.speed * dt;
+        else d.hasTarget = false;
+    }
 }
 
 void PlayState::drawBuildJobs(sf::RenderWindow& win){
     for (auto& job : buildJobs_){
-        if (!job.active) continue;
-
-        // Fantasma del edificio (cuadrado semi-transparente)
-        sf::RectangleShape ghost({40,40});
-        ghost.setOrigin(20,20);
+        // Fantasma del edificio (cuadrado semi-transparente); más tenue si sigue en cola
+        sf::RectangleShape& ghost = rectShape({Building::kSize, Building::kSize}, {Building::kSize/2, Building::kSize/2});
         ghost.setPosition(job.target);
-        ghost.setFillColor(sf::Color(120,160,120, 120)); // verde traslúcido
+        ghost.setFillColor(sf::Color(120,160,120, job.dozer < 0 ? 60 : 120)); // verde traslúcido
         win.draw(ghost);
 
         if (job.started){
             // Barra de progreso sobre el edificio
             float ratio = std::min(1.f, job.progress / job.buildTime);
-            sf::RectangleShape back({42,6}); back.setOrigin(21,20+8);
+            sf::RectangleShape& back = rectShape({42,6}, {21,20+8});
             back.setPosition(job.target);
             back.setFillColor(sf::Color(0,0,0,180));
             win.draw(back);
 
-            sf::RectangleShape fill({42.f*ratio,4}); fill.setOrigin(21,20+8);
+            sf::RectangleShape& fill = rectShape({42.f*ratio,4}, {21,20+8});
             fill.setPosition(job.target);
             fill.setFillColor(sf::Color(80,220,80));
             win.draw(fill);
         }
     }
 }
+
+// ==================== Formas reutilizables ====================
+// Se reusan entre frames: construir un sf::Shape por dibujo pide memoria al heap
+sf::CircleShape& PlayState::circleShape(float r){
+    circle_.setRadius(r);
+    circle_.setOrigin(r, r);
+    return circle_;
+}
+sf::CircleShape& PlayState::ringShape(float r){
+    ring_.setRadius(r);
+    ring_.setOrigin(r, r);
+    ring_.setFillColor(sf::Color::Transparent);
+    ring_.setOutlineColor(sf::Color::White);
+    ring_.setOutlineThickness(1.f);
+    return ring_;
+}
+sf::RectangleShape& PlayState::rectShape(sf::Vector2f size, sf::Vector2f origin){
+    rect_.setSize(size);
+    rect_.setOrigin(origin);
+    return rect_;
+}
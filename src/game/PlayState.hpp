@@ -6,9 +6,17 @@
 #include <SFML/Graphics.hpp>
 
 #include "../core/State.hpp"
+#include "../core/AsyncLoader.hpp"
 #include "../map/TileMap.hpp"
 #include "../map/FogOfWar.hpp"
+#include "../map/OccupancyGrid.hpp"
+#include "../map/UnitGrid.hpp"
 #include "../render/Renderer.hpp"
+#include "../render/Minimap.hpp"
+#include "../net/Lockstep.hpp"
+#include "Scenario.hpp"
+#include "TriggerSystem.hpp"
+#include "SelectionIndex.hpp"
 
 // === Tipos base de unidad ===
 enum class UnitType { Soldier, Harvester, Bulldozer, Minesweeper, Tank };
@@ -43,6 +51,10 @@ struct Ally {
     float cargoCap{100.f};
     int   resIdx{-1};
     bool  waiting{false};
+
+    // LOD de simulación
+    float lodDt{0.f};      // tiempo acumulado sin simular
+    bool  sleeping{false}; // idle: no se simula hasta wakeAlly()
 };
 
 // === Recursos y Edificios ===
@@ -52,10 +64,11 @@ struct ResourceNode {
 };
 
 struct Building {
+    static constexpr float kSize = 40.f; // lado en px (dibujo y huella en la grilla)
     enum class Type { HQ, Depot, Garage, Fort };
     Type type{Type::HQ};
     sf::Vector2f pos{};
-    std::vector<std::string> queue;
+    std::vector<UnitType> queue;
     float buildTimer{0.f};
 };
 
@@ -69,10 +82,13 @@ struct Mine {
 // === Job de construcción (Bulldozer) ===
 struct BuildJob {
     Building::Type type{Building::Type::HQ};
-    sf::Vector2f   target{};
+    sf::Vector2f   target{};          // centro de la huella
+    sf::IntRect    area{};            // tiles reservados en la grilla de ocupación
     float          progress{0.f};     // 0..buildTime
-    float          buildTime{2.0f};   // segundos
-    bool           active{false};
+    float          buildTime{2.0f};   // segundos (incluye clearTime)
+    float          clearTime{0.f};    // >0: primero despeja árboles de la huella (segundos)
+    int            priority{0};       // mayor = se asigna antes
+    int            dozer{-1};         // índice en bulldozers_ (-1 = en cola)
     bool           started{false};    // ya llegó el dozer al target
 };
 
@@ -83,6 +99,32 @@ class PlayState : public State {
 public:
     using State::State;
 
+    // Carga en dos partes (ver LoadState): CPU en segundo plano, luego GPU
+    void loadAsync(const AsyncLoader::Progress& progress);
+    void finishLoad();
+
+    // Mundo generado desde un ScenarioConfig (solo CPU, como loadAsync)
+    void loadScenario(const ScenarioConfig& cfg);
+
+    // Un frame sin ventana ni input: ticks de lockstep + niebla (tools/soak)
+    void stepHeadless(float dt);
+    void submitCommand(Command c){ lockstep_.submit(std::move(c)); }
+
+    // Lockstep de 2 jugadores sobre un enlace ya armado (tools/soak --peers 2:
+    // dos PlayState en el mismo proceso unidos por LoopbackTransport)
+    void connectPeer(int player, std::unique_ptr<Transport> link);
+    bool desynced() const { return lockstep_.desynced(); }
+    std::uint32_t simHash() const { return stateHash(); }
+
+    struct WorldStats {
+        int allySlots{0}, allies{0}, dozers{0}, buildings{0};
+        int mines{0}, resources{0}, buildJobs{0}, plastic{0};
+        unsigned tick{0};
+        std::uint64_t netBytes{0}, netPackets{0}; // enviados por lockstep (0 sin peers)
+    };
+    WorldStats   stats() const;
+    sf::Vector2f worldSize() const { return { map.width()*64.f, map.height()*64.f }; }
+
     void handleEvent(const sf::Event&) override;
     void update(float dt) override;
     void render(sf::RenderWindow&) override;
@@ -92,18 +134,36 @@ private:
     TileMap  map;
     FogOfWar fog;
     Renderer renderer;
+    Minimap  minimap;
 
     // --- Cámara/HUD ---
     sf::View cam;
     float    zoom{1.f};
     sf::Font font;
     sf::Text hud;
+    int      hudPlastic_{-1}, hudAllies_{-1}; // últimos valores mostrados
+    int      hudDetonated_{-1}, hudDefused_{-1};
+    bool     hudDesync_{false};
 
-    // --- Input selección (si quisieras selección múltiple más adelante) ---
+    // --- Input selección ---
     bool            dragging_{false};
+    bool            minimapClick_{false}; // el press fue sobre el minimapa
     sf::Vector2f    dragStart_{};
     sf::RectangleShape dragRect_{};
 
+    // Selección indexada (ver SelectionIndex); los flags `selected` solo se tocan por acá
+    static constexpr float kDoubleClickTime = 0.35f; // s
+    SelectionIndex selection_;
+    sf::Clock      clickClock_;
+    sf::Vector2f   lastClickPos_{-1000.f, -1000.f};
+    void select(UnitRef u);
+    void deselect(UnitRef u);
+    void clearSelection();
+    void selectTypeOnScreen(UnitType type);
+    void recallGroup(int g, bool add);
+    sf::Vector2f unitPos(UnitRef u) const;
+    UnitType     unitType(UnitRef u) const;
+
     // --- Estado de juego (Equipo A, economía, etc.) ---
     std::vector<Ally>     allies_;      // ejército aliado
     std::vector<ResourceNode> resources_;
@@ -115,26 +175,85 @@ private:
     // Costos (puedes cargarlo desde archivo luego)
     std::unordered_map<std::string, int> costs_{
         {"HQ",50},{"Depot",40},{"Garage",60},
-        {"Soldier",10},{"Tank",50},{"Harvester",25},{"Minesweeper",15}
+        {"Soldier",10},{"Tank",50},{"Harvester",25},{"Minesweeper",15},{"Bulldozer",40}
     };
 
-    // Bulldozer dedicado (lo mantenemos fuera del vector para claridad de la demo)
-    Unit bulldozer;
+    // Bulldozers (fuera de allies_: solo ellos construyen). Nunca se borran,
+    // mueren con alive=false, así los índices de BuildJob::dozer son estables
+    std::vector<Unit> bulldozers_;
 
-    // Construcción
+    // Construcción: cola de trabajos + qué hay en cada tile
     std::vector<BuildJob> buildJobs_;
+    OccupancyGrid         occupancy_;
+    std::vector<char>     dozerBusy_;   // scratch de assignBuildJobs
 
     // Fog
     bool showFog_{true};
 
+    // Unidades por celda (aliados + bulldozers con dozerRef) y minas por celda.
+    // Una unidad solo se prueba contra minas cuando se mueve, y solo contra las de su celda
+    UnitGrid      units_;
+    TriggerSystem triggers_;
+    std::size_t   eventsApplied_{0};   // eventos de triggers_ ya aplicados a la simulación
+    int           minesDetonated_{0}, minesDefused_{0};
+    void indexWorld();
+    void placeMine(sf::Vector2f p);
+    void onUnitMoved(UnitRef u, sf::Vector2f pos, bool sweeper);
+    void applyTriggerEvents();
+    void killUnit(UnitRef u);
+
+    // Destellos de minas (solo vista; salen de los eventos de triggers_)
+    struct Flash { sf::Vector2f pos; float t; sf::Color color; };
+    static constexpr float kFlashTime = 0.6f;
+    std::vector<Flash> flashes_;
+    void consumeTriggerEvents(float dt);
+
     // Player de pruebas (mantiene compatibilidad con tu base actual)
     //Unit player;
 
     // --- Funciones auxiliares (implementadas en PlayState.cpp) ---
-    void bulldozerBuildAttempt(const sf::Vector2f& pos);
+    void bulldozerBuildAttempt(const sf::Vector2f& pos, int priority=0);
+    void assignBuildJobs();
+    void releaseBuildJobs(int dozer);
     void updateBuildJobs(float dt);
     void drawBuildJobs(sf::RenderWindow& win);
 
+    // Formas reutilizadas en render (evitan new/delete por frame)
+    sf::CircleShape    circle_, ring_;
+    sf::RectangleShape rect_;
+    sf::CircleShape&    circleShape(float r);
+    sf::CircleShape&    ringShape(float r);
+    sf::RectangleShape& rectShape(sf::Vector2f size, sf::Vector2f origin);
+
+    // Aliados (simulación con LOD)
+    static constexpr unsigned kLodStride = 4;     // frames entre ticks lejos de la cámara
+    static constexpr float    kLodMargin = 128.f; // px alrededor de la vista que cuentan como "cerca"
+    void updateAlly(Ally& a, float dt);
+    void wakeAlly(Ally& a);
+    // Volquetas dormidas esperando recurso: se despiertan cuando cambia la
+    // economía (recurso nuevo, edificio terminado), no por sondeo
+    std::vector<std::uint32_t> waitingHarvesters_;
+    void addResource(sf::Vector2f pos, float amount);
+    void onEconomyChanged();
+    int  nearestResource(sf::Vector2f p) const;
+    sf::Vector2f depotPos() const;
+
+    // Lockstep: la simulación corre en ticks fijos y solo con las órdenes del tick
+    static constexpr float kTickDt = 1.f/60.f;
+    static constexpr float kMaxTicksPerFrame = 5.f; // tope de ponerse al día
+    static constexpr std::uint32_t kHashEvery = 30; // ticks entre hashes de estado (solo en red)
+    Lockstep lockstep_;
+    float    simAccum_{0.f};
+    void setupNetwork();
+    void submitQueue(Building::Type building, UnitType unit);
+    void applyCommand(const Command& c);
+    void stepSimulation(float dt);
+    void simulateTick(float dt);
+    std::uint32_t stateHash() const;
+
+    void revealFog();
+    void spawnUnit(UnitType type, sf::Vector2f pos);
+
     // Proyección de coordenadas
     sf::Vector2f screenToWorld(sf::RenderWindow& win, sf::Vector2i mouse) const;
 };
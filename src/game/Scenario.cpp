@@ -0,0 +1,139 @@
+#include "Scenario.hpp"
+#include "PlayState.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+// ==================== Presets ====================
+const std::vector<std::string>& scenarioPresetNames(){
+    static const std::vector<std::string> names{ "small", "medium", "large", "huge" };
+    return names;
+}
+
+bool scenarioPreset(const std::string& name, ScenarioConfig& c){
+    c = ScenarioConfig{};
+    c.name = name;
+    if (name == "small"){            // el mundo de siempre, con algunas minas
+        c.mineDensity = 0.5f;
+    } else if (name == "medium"){
+        c.mapW = 64;  c.mapH = 64;
+        c.soldiers = 100;  c.tanks = 10;  c.harvesters = 10;  c.minesweepers = 5;  c.bulldozers = 2;
+        c.plastic = 1000;
+        c.resourceDensity = 0.5f; c.mineDensity = 1.f;
+        c.orderInterval = 1.5f; c.movesPerWave = 3;  c.groupSize = 12;
+        c.queueChance = 0.8f;   c.buildChance = 0.2f; c.mineChance = 0.3f;
+    } else if (name == "large"){
+        c.mapW = 128; c.mapH = 128;
+        c.soldiers = 500;  c.tanks = 50;  c.harvesters = 40;  c.minesweepers = 20; c.bulldozers = 4;
+        c.plastic = 3000;
+        c.resourceDensity = 0.5f; c.mineDensity = 1.f;
+        c.orderInterval = 1.f;  c.movesPerWave = 6;  c.groupSize = 24;
+        c.queueChance = 1.f;    c.buildChance = 0.3f; c.mineChance = 0.5f;
+    } else if (name == "huge"){
+        c.mapW = 256; c.mapH = 256;
+        c.soldiers = 2000; c.tanks = 200; c.harvesters = 150; c.minesweepers = 80; c.bulldozers = 8;
+        c.plastic = 10000;
+        c.resourceDensity = 0.5f; c.mineDensity = 1.5f;
+        c.orderInterval = 0.5f; c.movesPerWave = 10; c.groupSize = 48;
+        c.queueChance = 1.f;    c.buildChance = 0.5f; c.mineChance = 1.f;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseScenario(const std::string& spec, ScenarioConfig& c){
+    std::size_t comma = spec.find(',');
+    if (!scenarioPreset(spec.substr(0, comma), c)) return false;
+
+    while (comma != std::string::npos){
+        std::size_t next = spec.find(',', comma+1);
+        std::string kv = spec.substr(comma+1, next == std::string::npos ? std::string::npos : next-comma-1);
+        comma = next;
+
+        std::size_t eq = kv.find('=');
+        if (eq == std::string::npos) return false;
+        std::string k = kv.substr(0, eq);
+        const char* v = kv.c_str() + eq + 1;
+        int   i = std::atoi(v);
+        float f = (float)std::atof(v);
+
+        if      (k == "seed")       c.seed = (std::uint32_t)std::strtoul(v, nullptr, 10);
+        else if (k == "w")          c.mapW = std::max(1, i);
+        else if (k == "h")          c.mapH = std::max(1, i);
+        else if (k == "soldiers")   c.soldiers = std::max(0, i);
+        else if (k == "tanks")      c.tanks = std::max(0, i);
+        else if (k == "harvesters") c.harvesters = std::max(0, i);
+        else if (k == "sweepers")   c.minesweepers = std::max(0, i);
+        else if (k == "dozers")     c.bulldozers = std::max(0, i);
+        else if (k == "plastic")    c.plastic = std::max(0, i);
+        else if (k == "resources")  c.resourceDensity = std::max(0.f, f);
+        else if (k == "mines")      c.mineDensity = std::max(0.f, f);
+        else if (k == "interval")   c.orderInterval = std::max(0.05f, f);
+        else if (k == "moves")      c.movesPerWave = std::max(0, i);
+        else if (k == "group")      c.groupSize = std::max(1, i);
+        else if (k == "queue")      c.queueChance = f;
+        else if (k == "build")      c.buildChance = f;
+        else if (k == "minechance") c.mineChance = f;
+        else return false;
+    }
+    return true;
+}
+
+// ==================== Órdenes scripted ====================
+ScenarioScript::ScenarioScript(const ScenarioConfig& cfg) : cfg_(cfg), rng_(cfg.seed ^ 0x5DEECE66u) {}
+
+// Cada orderInterval segundos: movesPerWave grupos de aliados a puntos al azar,
+// y con cierta probabilidad una unidad a producir, un edificio y una mina
+void ScenarioScript::update(float dt, PlayState& play){
+    timer_ += dt;
+    if (timer_ < cfg_.orderInterval) return;
+    timer_ -= cfg_.orderInterval;
+    ++wave_;
+
+    const PlayState::WorldStats st = play.stats();
+    sf::Vector2f world = play.worldSize();
+    auto randomPoint = [&]{
+        return sf::Vector2i{ (int)rng_.range(32.f, world.x - 32.f), (int)rng_.range(32.f, world.y - 32.f) };
+    };
+
+    // Move: un bloque contiguo de índices (las refs muertas se ignoran al aplicar)
+    for (int m=0; m<cfg_.movesPerWave && st.allySlots > 0; ++m){
+        Command c;
+        c.type = CommandType::Move;
+        sf::Vector2i p = randomPoint(); c.x = p.x; c.y = p.y;
+        int n = std::min(cfg_.groupSize, st.allySlots);
+        int first = rng_.below(st.allySlots - n + 1);
+        c.units.reserve(n);
+        for (int i=0; i<n; ++i) c.units.push_back(allyRef((std::uint32_t)(first + i)));
+        play.submitCommand(std::move(c));
+        ++orders_;
+    }
+    if (rng_.unit() < cfg_.queueChance){
+        // Rota por los tipos producibles, en el mismo edificio que usan las teclas
+        static const UnitType cycle[] = { UnitType::Soldier, UnitType::Harvester, UnitType::Soldier,
+                                          UnitType::Tank, UnitType::Minesweeper, UnitType::Bulldozer };
+        UnitType u = cycle[wave_ % 6];
+        Command c;
+        c.type = CommandType::Queue;
+        bool hq = (u == UnitType::Soldier || u == UnitType::Minesweeper);
+        c.building = (std::uint8_t)(hq ? Building::Type::HQ : Building::Type::Garage);
+        c.unit = (std::uint8_t)u;
+        play.submitCommand(std::move(c));
+        ++orders_;
+    }
+    if (rng_.unit() < cfg_.buildChance){
+        Command c;
+        c.type = CommandType::Build;
+        sf::Vector2i p = randomPoint(); c.x = p.x; c.y = p.y;
+        c.priority = (std::uint8_t)rng_.below(2);
+        play.submitCommand(std::move(c));
+        ++orders_;
+    }
+    if (rng_.unit() < cfg_.mineChance){
+        Command c;
+        c.type = CommandType::PlaceMine;
+        sf::Vector2i p = randomPoint(); c.x = p.x; c.y = p.y;
+        play.submitCommand(std::move(c));
+        ++orders_;
+    }
+}
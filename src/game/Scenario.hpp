@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class PlayState;
+
+// === Escenarios parametrizados (pruebas de carga / soak) ===
+// Un escenario describe un mundo completo: tamaño del mapa, mezcla de unidades,
+// densidad de recursos y minas, y el ritmo de órdenes scripted. Con la misma
+// semilla sale siempre el mismo mundo y las mismas órdenes.
+struct ScenarioConfig {
+    std::string   name{"custom"};
+    std::uint32_t seed{1};
+
+    int mapW{32}, mapH{20};   // tiles
+
+    // Mezcla inicial de unidades
+    int soldiers{5}, tanks{0}, harvesters{2}, minesweepers{1}, bulldozers{1};
+    int plastic{300};
+
+    float resourceDensity{0.3f}; // nodos por cada 100 tiles
+    float mineDensity{0.f};      // minas por cada 100 tiles
+
+    // Órdenes scripted (ver ScenarioScript)
+    float orderInterval{2.f};    // s entre oleadas
+    int   movesPerWave{1};       // órdenes Move por oleada
+    int   groupSize{4};          // unidades por Move
+    float queueChance{0.5f};     // prob. por oleada de encolar una unidad
+    float buildChance{0.1f};     // prob. por oleada de pedir un edificio
+    float mineChance{0.1f};      // prob. por oleada de plantar una mina
+};
+
+// Presets: "small", "medium", "large", "huge" (de menor a mayor)
+const std::vector<std::string>& scenarioPresetNames();
+bool scenarioPreset(const std::string& name, ScenarioConfig& out);
+
+// "preset[,clave=valor...]", ej. "large,seed=7,mines=2.5,w=200".
+// Claves: seed w h soldiers tanks harvesters sweepers dozers plastic
+//         resources mines interval moves group queue build minechance
+bool parseScenario(const std::string& spec, ScenarioConfig& out);
+
+// PRNG pequeño y portable (xorshift32): std::uniform_*_distribution no da los
+// mismos números en todas las bibliotecas estándar
+struct ScenarioRng {
+    std::uint32_t s;
+    explicit ScenarioRng(std::uint32_t seed) : s(seed ? seed : 0x9E3779B9u) {}
+    std::uint32_t next(){ s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+    int   below(int n){ return n > 0 ? (int)(next() % (std::uint32_t)n) : 0; }
+    float unit(){ return (next() >> 8) * (1.f / 16777216.f); }
+    float range(float a, float b){ return a + (b - a) * unit(); }
+};
+
+// Genera las órdenes del escenario y las entrega por lockstep, igual que el input
+class ScenarioScript {
+public:
+    explicit ScenarioScript(const ScenarioConfig& cfg);
+    void update(float dt, PlayState& play);
+    unsigned ordersIssued() const { return orders_; }
+private:
+    ScenarioConfig cfg_;
+    ScenarioRng    rng_;
+    float          timer_{0.f};
+    unsigned       orders_{0};
+    unsigned       wave_{0};
+};
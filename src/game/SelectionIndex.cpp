@@ -0,0 +1,36 @@
+#include "SelectionIndex.hpp"
+
+int& SelectionIndex::slot(UnitRef u){
+    auto& t = m_slots[(u & kDozerRef) ? 1 : 0];
+    std::uint32_t i = u & ~kDozerRef;
+    if (i >= t.size()) t.resize(i+1, -1);
+    return t[i];
+}
+
+int SelectionIndex::slotOf(UnitRef u) const{
+    const auto& t = m_slots[(u & kDozerRef) ? 1 : 0];
+    std::uint32_t i = u & ~kDozerRef;
+    return i < t.size() ? t[i] : -1;
+}
+
+bool SelectionIndex::contains(UnitRef u) const{ return slotOf(u) >= 0; }
+
+bool SelectionIndex::add(UnitRef u){
+    int& s = slot(u);
+    if (s >= 0) return false;
+    s = (int)m_units.size();
+    m_units.push_back(u);
+    return true;
+}
+
+// Swap con el último: O(1), el orden de la lista no importa
+bool SelectionIndex::remove(UnitRef u){
+    int s = slotOf(u);
+    if (s < 0) return false;
+    UnitRef last = m_units.back();
+    m_units[s] = last;
+    slot(last) = s;
+    m_units.pop_back();
+    slot(u) = -1;
+    return true;
+}
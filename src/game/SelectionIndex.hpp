@@ -0,0 +1,43 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "../net/Command.hpp"
+
+// === Selección del jugador local ===
+// Lista densa de UnitRef seleccionados + posición de cada uno en la lista, así
+// agregar/quitar es O(1) y limpiar o dar una orden cuesta O(seleccionados),
+// no O(ejército). Los flags `selected` de las unidades los mantiene PlayState
+// (select/deselect/clearSelection) en el mismo paso.
+//
+// Grupos de control 0..9 (Ctrl+número guarda, número recupera). Los grupos
+// guardan refs; las unidades muertas se descartan al recuperarlos.
+class SelectionIndex {
+public:
+    static constexpr int kGroups = 10;
+
+    bool add(UnitRef u);
+    bool remove(UnitRef u);
+    bool contains(UnitRef u) const;
+
+    const std::vector<UnitRef>& units() const { return m_units; }
+    bool empty() const { return m_units.empty(); }
+
+    // Vacía la selección; f(ref) por cada unidad que sale (para bajar su flag)
+    template<class F>
+    void clear(F&& f){
+        for (UnitRef u : m_units){ f(u); slot(u) = -1; }
+        m_units.clear();
+    }
+
+    void storeGroup(int g){ if (g>=0 && g<kGroups) m_groups[g] = m_units; }
+    std::vector<UnitRef>& group(int g){ return m_groups[g]; }
+
+private:
+    int& slot(UnitRef u);
+    int  slotOf(UnitRef u) const;
+
+    std::vector<UnitRef> m_units;        // seleccionados (orden arbitrario)
+    std::vector<int>     m_slots[2];     // posición en m_units por ref (aliados / dozers), -1 = no
+    std::array<std::vector<UnitRef>, kGroups> m_groups;
+};
@@ -0,0 +1,73 @@
+#include "TriggerSystem.hpp"
+#include <algorithm>
+#include <cmath>
+
+void TriggerSystem::init(float worldW, float worldH, float cellPx){
+    m_cell = cellPx;
+    m_cols = std::max(1, (int)std::ceil(worldW/cellPx));
+    m_rows = std::max(1, (int)std::ceil(worldH/cellPx));
+    m_cells.assign((std::size_t)m_cols*m_rows, {});
+    m_mines.clear();
+    m_events.clear();
+}
+
+int TriggerSystem::cellOf(sf::Vector2f p) const{
+    int cx = std::min(m_cols-1, std::max(0, (int)std::floor(p.x/m_cell)));
+    int cy = std::min(m_rows-1, std::max(0, (int)std::floor(p.y/m_cell)));
+    return cy*m_cols + cx;
+}
+
+void TriggerSystem::addMine(int idx, sf::Vector2f pos, float radius){
+    if (m_cells.empty() || idx < 0) return;
+    if (idx >= (int)m_mines.size()) m_mines.resize(idx+1);
+    MineInfo& m = m_mines[idx];
+    m.pos = pos; m.armed = true;
+
+    // Celdas de cada zona; la de detección contiene a la de disparo
+    auto span = [&](float r, int& c0, int& r0, int& c1, int& r1){
+        int a = cellOf({pos.x - r, pos.y - r}), b = cellOf({pos.x + r, pos.y + r});
+        c0 = a % m_cols; r0 = a / m_cols; c1 = b % m_cols; r1 = b / m_cols;
+    };
+    float reach = std::max(radius, kDetectRadius);
+    span(reach, m.c0, m.r0, m.c1, m.r1);
+    int tc0, tr0, tc1, tr1;
+    span(radius, tc0, tr0, tc1, tr1);
+
+    for (int y=m.r0; y<=m.r1; ++y)
+        for (int x=m.c0; x<=m.c1; ++x){
+            auto& cell = m_cells[(std::size_t)y*m_cols + x];
+            cell.push_back({ idx, kDetectRadius*kDetectRadius, true });
+            if (x>=tc0 && x<=tc1 && y>=tr0 && y<=tr1) cell.push_back({ idx, radius*radius, false });
+        }
+}
+
+// Saca las zonas de la mina de sus celdas y encola el evento
+void TriggerSystem::disarm(int idx, TriggerEvent::Type type, UnitRef u){
+    MineInfo& m = m_mines[idx];
+    m.armed = false;
+    for (int y=m.r0; y<=m.r1; ++y)
+        for (int x=m.c0; x<=m.c1; ++x){
+            auto& cell = m_cells[(std::size_t)y*m_cols + x];
+            cell.erase(std::remove_if(cell.begin(), cell.end(), [idx](const Zone& z){ return z.mine == idx; }), cell.end());
+        }
+    m_events.push_back({ type, idx, u, m.pos });
+}
+
+bool TriggerSystem::test(UnitRef u, sf::Vector2f pos, bool sweeper){
+    if (m_cells.empty()) return false;
+    const auto& cell = m_cells[cellOf(pos)];
+    if (cell.empty()) return false;
+
+    auto inside = [&](const Zone& z){
+        sf::Vector2f d = pos - m_mines[z.mine].pos;
+        return d.x*d.x + d.y*d.y < z.r2;
+    };
+    // El busca-minas detecta antes de pisar (una mina por prueba)
+    if (sweeper){
+        for (const Zone& z : cell)
+            if (z.detect && inside(z)){ disarm(z.mine, TriggerEvent::Type::Defused, u); break; }
+    }
+    for (const Zone& z : cell)
+        if (!z.detect && inside(z)){ disarm(z.mine, TriggerEvent::Type::Detonated, u); return true; }
+    return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "../net/Command.hpp"
+
+// === Evento de trigger (mina) ===
+// Se encolan durante la simulación; la simulación los aplica al final del tick
+// y render/HUD los leen en el mismo frame, antes de clearEvents()
+struct TriggerEvent {
+    enum class Type : std::uint8_t { Detonated, Defused };
+    Type         type{Type::Detonated};
+    int          mine{-1};   // índice en mines_
+    UnitRef      unit{0};    // quién la pisó / la detectó
+    sf::Vector2f pos{};
+};
+
+// Minas por celda: cada mina se registra una sola vez en las celdas que tocan
+// su zona de disparo (cualquier unidad) y su zona de detección (busca-minas).
+// Una unidad que se movió solo se prueba contra las zonas de su celda, así que
+// en celdas sin minas el costo es una lectura, sin importar cuántas minas haya.
+class TriggerSystem {
+public:
+    static constexpr float kDetectRadius = 42.f; // radio de detección del busca-minas
+
+    void init(float worldW, float worldH, float cellPx=64.f);
+
+    // Registra la mina idx (índice en mines_); queda armada
+    void addMine(int idx, sf::Vector2f pos, float radius);
+
+    // La unidad u está en pos (se movió o hay una mina nueva cerca).
+    // Devuelve true si detonó una mina (la unidad muere al aplicar el evento)
+    bool test(UnitRef u, sf::Vector2f pos, bool sweeper);
+
+    bool armed(int idx) const { return idx>=0 && idx<(int)m_mines.size() && m_mines[idx].armed; }
+
+    const std::vector<TriggerEvent>& events() const { return m_events; }
+    void clearEvents(){ m_events.clear(); }
+
+private:
+    struct Zone {
+        int   mine;
+        float r2;        // radio al cuadrado
+        bool  detect;    // true = zona de detección (solo busca-minas)
+    };
+    struct MineInfo {
+        sf::Vector2f pos{};
+        bool armed{false};
+        int  c0{0}, r0{0}, c1{-1}, r1{-1}; // celdas registradas (rect inclusivo)
+    };
+
+    int  cellOf(sf::Vector2f p) const;
+    void disarm(int idx, TriggerEvent::Type type, UnitRef u);
+
+    float m_cell{64.f};
+    int   m_cols{0}, m_rows{0};
+    std::vector<std::vector<Zone>> m_cells;
+    std::vector<MineInfo>          m_mines;
+    std::vector<TriggerEvent>      m_events;
+};
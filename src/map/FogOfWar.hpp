@@ -1,38 +1,221 @@
-
 #pragma once
 #include <SFML/Graphics.hpp>
 #include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include "TileMap.hpp"
 
+// Line-of-sight fog, one bitplane per team (+ an "explored" plane per team).
+// Rows are packed 64 tiles per word, so a query is a shift and a mask and a
+// reveal is a handful of word ORs.
+//
+// Each (origin tile, radius) pair is shadowcast once over the TileMap blockers
+// and cached as a "stamp": the visible tiles already packed into map-aligned
+// words. Open areas skip the shadowcast and stamp the precomputed circle mask
+// for that radius. Stamps are dropped only when a tile inside their reach
+// changes (see onTileChanged).
 class FogOfWar{
 public:
-    void init(int w,int h){ m_w=w; m_h=h; m_vis.assign(w*h, 0); }
-    void clear(){ std::fill(m_vis.begin(), m_vis.end(), 0); }
-    void revealCircle(sf::Vector2f world, float radius){
-        int gx = (int)(world.x/64); int gy = (int)(world.y/64);
-        int r = (int)(radius/64)+1;
-        for(int y=gy-r;y<=gy+r;++y){
-            for(int x=gx-r;x<=gx+r;++x){
-                if(x>=0&&y>=0&&x<m_w&&y<m_h){
-                    float cx=x*64+32, cy=y*64+32;
-                    float dx=cx-world.x, dy=cy-world.y;
-                    if(dx*dx+dy*dy <= radius*radius) m_vis[y*m_w+x]=1;
-                }
-            }
+    static constexpr int kMaxTeams = 8;
+
+    void init(const TileMap& map, int teams=1){
+        m_map=&map; m_w=map.width(); m_h=map.height();
+        m_teams = std::max(1, std::min(teams, kMaxTeams));
+        m_wpr = (m_w+63)/64;
+        m_visible.assign((std::size_t)m_teams*m_h*m_wpr, 0);
+        m_explored.assign((std::size_t)m_teams*m_h*m_wpr, 0);
+        m_stamps.clear();
+        m_circles.clear();
+        buildGeometry();
+    }
+    void clear(){ std::fill(m_visible.begin(), m_visible.end(), 0); ++m_epoch; }
+    void revealAll(int team=0){
+        for(int y=0;y<m_h;++y){
+            std::uint64_t* v = row(m_visible, team, y);
+            std::uint64_t* e = row(m_explored, team, y);
+            for(int w=0;w<m_wpr;++w){ v[w] = e[w] = tailMask(w); }
+        }
+    }
+    void revealCircle(sf::Vector2f world, float radius, int team=0){
+        int gx = (int)std::floor(world.x/64); int gy = (int)std::floor(world.y/64);
+        if(!m_map || !m_map->inBounds(gx,gy) || team<0 || team>=m_teams) return;
+        int rq = (int)std::lround(radius);
+        Stamp& s = m_stamps[key(gx,gy,rq)];
+        if(!s.built){ build(s, gx, gy, rq); }
+        if(s.epoch[team]==m_epoch) return; // another unit on this tile already applied it
+        s.epoch[team] = m_epoch;
+        const std::uint64_t* src = s.bits.data();
+        for(int r=0;r<s.rows;++r, src+=s.wn){
+            std::uint64_t* v = row(m_visible,  team, s.y0+r) + s.w0;
+            std::uint64_t* e = row(m_explored, team, s.y0+r) + s.w0;
+            for(int w=0;w<s.wn;++w){ v[w] |= src[w]; e[w] |= src[w]; }
+        }
+    }
+    // Drop every cached stamp whose reach covers (gx,gy)
+    void onTileChanged(int gx,int gy){
+        for(auto it=m_stamps.begin(); it!=m_stamps.end();){
+            const Stamp& s = it->second;
+            if(std::abs(s.ox-gx)<=s.reach && std::abs(s.oy-gy)<=s.reach) it = m_stamps.erase(it);
+            else ++it;
         }
     }
+    bool isVisible(int team,int gx,int gy) const { return testBit(m_visible, team, gx, gy); }
+    bool isExplored(int team,int gx,int gy) const { return testBit(m_explored, team, gx, gy); }
+    int  teams() const { return m_teams; }
+    int  wordsPerRow() const { return m_wpr; }
+    const std::uint64_t* visibleRow(int team,int gy) const { return m_visible.data() + ((std::size_t)team*m_h + gy)*m_wpr; }
+    const std::uint64_t* exploredRow(int team,int gy) const { return m_explored.data() + ((std::size_t)team*m_h + gy)*m_wpr; }
+
+    void setViewer(int team){ m_viewer = std::max(0, std::min(team, m_teams-1)); }
+    // Positions are prebuilt in init(); each frame only the alpha of every quad
+    // is rewritten and the fog goes out in one draw call
     void render(sf::RenderTarget& rt, float alpha=0.65f) const{
-        sf::RectangleShape r({64,64});
+        const sf::Color clear(0,0,0,0);
+        const sf::Color seen(0,0,0,(sf::Uint8)(alpha*255));
+        const sf::Color unseen(0,0,0,(sf::Uint8)std::min(255.f, alpha*255+70));
         for(int y=0;y<m_h;++y){
             for(int x=0;x<m_w;++x){
-                if(m_vis[y*m_w+x]==0){
-                    r.setFillColor(sf::Color(0,0,0,(sf::Uint8)(alpha*255)));
-                    r.setPosition(x*64.f,y*64.f);
-                    rt.draw(r);
-                }
+                sf::Color c = isVisible(m_viewer,x,y) ? clear : isExplored(m_viewer,x,y) ? seen : unseen;
+                sf::Vertex* q = &m_quads[((std::size_t)y*m_w+x)*4];
+                q[0].color = q[1].color = q[2].color = q[3].color = c;
             }
         }
+        rt.draw(m_quads);
     }
 private:
-    int m_w=0,m_h=0;
-    std::vector<unsigned char> m_vis;
+    struct Stamp{
+        int ox=0, oy=0, reach=0;
+        bool built=false;
+        unsigned epoch[kMaxTeams]{};     // last clear() cycle it was applied in, per team
+        int y0=0, rows=0, w0=0, wn=0;    // covered rows and word columns (map-aligned)
+        std::vector<std::uint64_t> bits; // rows*wn words
+    };
+    // Disc of a given radius as per-row half widths (row 0 is dy=-reach)
+    struct Circle{
+        int reach=0;
+        std::vector<int> half;
+    };
+
+    static std::uint64_t key(int gx,int gy,int radiusPx){
+        return ((std::uint64_t)(std::uint32_t)(gy*65536+gx) << 32) | (std::uint32_t)radiusPx;
+    }
+    std::uint64_t* row(std::vector<std::uint64_t>& p,int team,int gy){ return p.data() + ((std::size_t)team*m_h + gy)*m_wpr; }
+    bool testBit(const std::vector<std::uint64_t>& p,int team,int gx,int gy) const{
+        if(gx<0||gy<0||gx>=m_w||gy>=m_h||team<0||team>=m_teams) return false;
+        return (p[((std::size_t)team*m_h + gy)*m_wpr + (gx>>6)] >> (gx&63)) & 1u;
+    }
+    std::uint64_t tailMask(int w) const{
+        int bits = m_w - w*64;
+        return bits>=64 ? ~0ull : ((1ull<<bits)-1);
+    }
+
+    const Circle& circle(int radiusPx){
+        Circle& c = m_circles[radiusPx];
+        if(c.half.empty()){
+            float r = radiusPx/64.f;
+            c.reach = (int)std::ceil(r);
+            for(int dy=-c.reach; dy<=c.reach; ++dy){
+                int hw=-1;
+                while(hw+1<=c.reach && float((hw+1)*(hw+1)+dy*dy) <= r*r) ++hw;
+                c.half.push_back(hw);
+            }
+        }
+        return c;
+    }
+
+    void setBit(Stamp& s,int x,int y){
+        int i = x - s.w0*64;
+        s.bits[(std::size_t)(y-s.y0)*s.wn + (i>>6)] |= 1ull << (i&63);
+    }
+
+    void build(Stamp& s, int gx, int gy, int radiusPx){
+        const Circle& c = circle(radiusPx);
+        float r = radiusPx/64.f;
+        s.ox=gx; s.oy=gy; s.reach=c.reach; s.built=true;
+        int reach = c.reach;
+        int x0 = std::max(0, gx-reach), x1 = std::min(m_w-1, gx+reach);
+        s.y0 = std::max(0, gy-reach);
+        s.rows = std::min(m_h-1, gy+reach) - s.y0 + 1;
+        s.w0 = x0>>6; s.wn = (x1>>6) - s.w0 + 1;
+        s.bits.assign((std::size_t)s.rows*s.wn, 0);
+
+        // Fast path: no blockers in range → OR the circle spans in directly
+        bool open = true;
+        for(int y=s.y0; y<s.y0+s.rows && open; ++y)
+            for(int x=x0;x<=x1;++x)
+                if(m_map->blocksSight(x,y)){ open=false; break; }
+        if(open){
+            for(int y=s.y0; y<s.y0+s.rows; ++y){
+                int hw = c.half[y-gy+reach];
+                for(int x=std::max(x0,gx-hw); x<=std::min(x1,gx+hw); ++x) setBit(s,x,y);
+            }
+            return;
+        }
+        // Recursive shadowcasting over the 8 octants
+        auto mark = [&](int x,int y){ setBit(s,x,y); };
+        mark(gx,gy);
+        static const int mult[4][8] = {
+            {1, 0, 0,-1,-1, 0, 0, 1},
+            {0, 1,-1, 0, 0,-1, 1, 0},
+            {0, 1, 1, 0, 0,-1,-1, 0},
+            {1, 0, 0, 1,-1, 0, 0,-1}
+        };
+        for(int o=0;o<8;++o)
+            castLight(gx, gy, 1, 1.f, 0.f, reach, r, mult[0][o], mult[1][o], mult[2][o], mult[3][o], mark);
+    }
+
+    template<class Mark>
+    void castLight(int cx,int cy,int row,float start,float end,int reach,float r,
+                   int xx,int xy,int yx,int yy, Mark& mark) const{
+        if(start < end) return;
+        float newStart = 0.f;
+        for(int j=row; j<=reach; ++j){
+            int dx=-j-1, dy=-j;
+            bool blocked=false;
+            while(dx<=0){
+                ++dx;
+                int X = cx + dx*xx + dy*xy;
+                int Y = cy + dx*yx + dy*yy;
+                float lSlope = (dx-0.5f)/(dy+0.5f);
+                float rSlope = (dx+0.5f)/(dy-0.5f);
+                if(start < rSlope) continue;
+                if(end > lSlope) break;
+                if(m_map->inBounds(X,Y) && float(dx*dx+dy*dy) <= r*r) mark(X,Y);
+                bool wall = m_map->blocksSight(X,Y);
+                if(blocked){
+                    if(wall){ newStart = rSlope; continue; }
+                    blocked=false; start=newStart;
+                }else if(wall && j<reach){
+                    blocked=true;
+                    castLight(cx, cy, j+1, start, lSlope, reach, r, xx, xy, yx, yy, mark);
+                    newStart = rSlope;
+                }
+            }
+            if(blocked) break;
+        }
+    }
+
+    const TileMap* m_map=nullptr;
+    int m_w=0,m_h=0,m_wpr=0,m_teams=1,m_viewer=0;
+    unsigned m_epoch=1;
+    std::vector<std::uint64_t> m_visible;   // [team][row][word]
+    std::vector<std::uint64_t> m_explored;  // [team][row][word]
+    std::unordered_map<std::uint64_t, Stamp> m_stamps;
+    std::unordered_map<int, Circle> m_circles;
+    mutable sf::VertexArray m_quads; // one quad per tile, only colors change per frame
+
+    void buildGeometry(){
+        m_quads.setPrimitiveType(sf::Quads);
+        m_quads.resize((std::size_t)m_w*m_h*4);
+        for(int y=0;y<m_h;++y)
+            for(int x=0;x<m_w;++x){
+                sf::Vertex* q = &m_quads[((std::size_t)y*m_w+x)*4];
+                q[0].position = {x*64.f,     y*64.f};
+                q[1].position = {x*64.f+64.f, y*64.f};
+                q[2].position = {x*64.f+64.f, y*64.f+64.f};
+                q[3].position = {x*64.f,     y*64.f+64.f};
+            }
+    }
 };
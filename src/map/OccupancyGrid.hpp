@@ -0,0 +1,57 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "TileMap.hpp"
+
+// What stands on each tile, for placement checks. Buildings use a footprint
+// in whole tiles anchored at their top-left tile, so a check touches
+// fw*fh cells no matter how big the map is.
+class OccupancyGrid {
+public:
+    enum Cell : unsigned char { Free=0, Building=1, Reserved=2, Resource=3 };
+
+    void init(const TileMap& map){
+        m_map=&map; m_w=map.width(); m_h=map.height();
+        m_cells.assign(m_w*m_h, Free);
+    }
+    static sf::Vector2i tileOf(sf::Vector2f world){ return { (int)std::floor(world.x/64), (int)std::floor(world.y/64) }; }
+    static sf::Vector2f centerOf(sf::Vector2i t){ return { t.x*64.f+32.f, t.y*64.f+32.f }; }
+
+    // Footprint of a sizePx building anchored at tile t: ceil(size/tile) per side
+    static sf::IntRect footprint(sf::Vector2i t, sf::Vector2f sizePx){
+        return { t.x, t.y, std::max(1, (int)std::ceil(sizePx.x/64)), std::max(1, (int)std::ceil(sizePx.y/64)) };
+    }
+    // Tiles touched by an already placed building (center in px); it may straddle tile edges
+    static sf::IntRect footprintAt(sf::Vector2f center, sf::Vector2f sizePx){
+        sf::Vector2i a = tileOf({ center.x - sizePx.x/2, center.y - sizePx.y/2 });
+        sf::Vector2i b = tileOf({ center.x + sizePx.x/2 - 0.01f, center.y + sizePx.y/2 - 0.01f });
+        return { a.x, a.y, b.x-a.x+1, b.y-a.y+1 };
+    }
+    // Pixel center of a footprint (where the building is drawn)
+    static sf::Vector2f centerOf(const sf::IntRect& r){ return { (r.left + r.width/2.f)*64.f, (r.top + r.height/2.f)*64.f }; }
+
+    // treesOk: trees count as free (a bulldozer clears them before building)
+    bool canPlace(sf::Vector2i t, int fw=1, int fh=1, bool treesOk=false) const{
+        for(int y=t.y;y<t.y+fh;++y)
+            for(int x=t.x;x<t.x+fw;++x){
+                if(!m_map->inBounds(x,y)) return false;
+                if(m_cells[y*m_w+x]!=Free || (!treesOk && m_map->tileAt(x,y)==TileMap::Tree)) return false;
+            }
+        return true;
+    }
+    bool canPlace(const sf::IntRect& r, bool treesOk=false) const{ return canPlace({r.left, r.top}, r.width, r.height, treesOk); }
+    void set(sf::Vector2i t, Cell c, int fw=1, int fh=1){
+        for(int y=t.y;y<t.y+fh;++y)
+            for(int x=t.x;x<t.x+fw;++x)
+                if(m_map->inBounds(x,y)) m_cells[y*m_w+x]=c;
+    }
+    void set(const sf::IntRect& r, Cell c){ set({r.left, r.top}, c, r.width, r.height); }
+    Cell at(int gx,int gy) const { return m_map->inBounds(gx,gy) ? (Cell)m_cells[gy*m_w+gx] : Building; }
+
+private:
+    const TileMap* m_map=nullptr;
+    int m_w=0, m_h=0;
+    std::vector<unsigned char> m_cells;
+};
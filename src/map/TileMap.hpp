@@ -1,33 +1,80 @@
-
 #pragma once
 #include <SFML/Graphics.hpp>
 #include <vector>
+#include <functional>
 
 class TileMap {
 public:
+    enum Tile { Grass=0, Path=1, Tree=2 };
+
     void generate(int w, int h){
-        m_w=w; m_h=h; m_tiles.assign(w*h, 0);
+        m_w=w; m_h=h; m_tiles.assign(w*h, Grass);
         // Simple path band
         for(int x=0;x<m_w;++x){
             int y = m_h/2 + (x%5==0?1:0);
-            if(y>=0 && y<m_h) m_tiles[y*m_w+x]=1;
+            if(y>=0 && y<m_h) m_tiles[y*m_w+x]=Path;
         }
+        // Tree clusters (fixed seed so every run sees the same map); the
+        // top-left corner is kept clear for the starting base and resources
+        unsigned seed = 0x2545F491u;
+        auto rnd = [&seed](int n){ seed = seed*1664525u + 1013904223u; return (int)((seed>>16) % (unsigned)n); };
+        int clusters = (m_w*m_h)/160;
+        for(int c=0;c<clusters;++c){
+            int cx = rnd(m_w), cy = rnd(m_h);
+            for(int k=0;k<5;++k){
+                int x = cx + rnd(3)-1, y = cy + rnd(3)-1;
+                if(!inBounds(x,y) || (x<13 && y<9)) continue;
+                if(m_tiles[y*m_w+x]==Grass) m_tiles[y*m_w+x]=Tree;
+            }
+        }
+        buildGeometry();
     }
-    void render(sf::RenderTarget& rt) const{
-        sf::RectangleShape r({64,64});
-        for(int y=0;y<m_h;++y){
+    // One quad per tile, built once (CPU only, safe off the main thread);
+    // the whole map is then a single draw call
+    void buildGeometry(){
+        m_quads.setPrimitiveType(sf::Quads);
+        m_quads.resize((std::size_t)m_w*m_h*4);
+        for(int y=0;y<m_h;++y)
             for(int x=0;x<m_w;++x){
-                r.setPosition(x*64.f,y*64.f);
-                if(m_tiles[y*m_w+x]==0) r.setFillColor(sf::Color(90,160,70));
-                else                    r.setFillColor(sf::Color(170,135,95));
-                rt.draw(r);
+                sf::Vertex* q = &m_quads[((std::size_t)y*m_w+x)*4];
+                q[0].position = {x*64.f,     y*64.f};
+                q[1].position = {x*64.f+64.f, y*64.f};
+                q[2].position = {x*64.f+64.f, y*64.f+64.f};
+                q[3].position = {x*64.f,     y*64.f+64.f};
+                recolor(x,y);
             }
-        }
+    }
+    void render(sf::RenderTarget& rt) const{ rt.draw(m_quads); }
+    static sf::Color colorOf(int t){
+        if(t==Grass) return sf::Color(90,160,70);
+        if(t==Path)  return sf::Color(170,135,95);
+        return sf::Color(40,95,40);
     }
     bool inBounds(int gx,int gy) const { return gx>=0&&gy>=0&&gx<m_w&&gy<m_h; }
+    int  tileAt(int gx,int gy) const { return m_tiles[gy*m_w+gx]; }
+    // Out-of-bounds counts as opaque so sight never leaks off the map
+    bool blocksSight(int gx,int gy) const { return !inBounds(gx,gy) || m_tiles[gy*m_w+gx]==Tree; }
+    // Returns true when the tile actually changed; the change callback is how
+    // the caches built on top of the map (fog stamps, minimap texels) find out
+    bool setTile(int gx,int gy,int t){
+        if(!inBounds(gx,gy) || m_tiles[gy*m_w+gx]==t) return false;
+        m_tiles[gy*m_w+gx]=t;
+        if(m_quads.getVertexCount()) recolor(gx,gy);
+        if(m_onChanged) m_onChanged(gx,gy);
+        return true;
+    }
+    void setOnTileChanged(std::function<void(int,int)> f){ m_onChanged = std::move(f); }
     int width()  const { return m_w; }
     int height() const { return m_h; }
 private:
     int m_w=0, m_h=0;
-    std::vector<int> m_tiles; // 0 grass, 1 path
+    std::vector<int> m_tiles; // 0 grass, 1 path, 2 tree (blocks sight)
+    sf::VertexArray  m_quads;
+    std::function<void(int,int)> m_onChanged;
+
+    void recolor(int gx,int gy){
+        sf::Vertex* q = &m_quads[((std::size_t)gy*m_w+gx)*4];
+        sf::Color c = colorOf(m_tiles[gy*m_w+gx]);
+        for(int i=0;i<4;++i) q[i].color = c;
+    }
 };
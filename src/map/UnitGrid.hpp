@@ -0,0 +1,83 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Units bucketed by cell, for "who is around here" queries. Every handle
+// remembers its cell, so moving a unit is free unless it crosses a cell
+// border; then it is a swap-erase in the old bucket and a push in the new one.
+//
+// Handles are 32-bit; the high bit selects a second slot table so two index
+// spaces can share the grid (the game uses it for allies vs. bulldozers).
+class UnitGrid {
+public:
+    static constexpr std::uint32_t kHighBit = 0x80000000u;
+
+    void init(float worldW, float worldH, float cellPx=64.f){
+        m_cell = cellPx;
+        m_cols = std::max(1, (int)std::ceil(worldW/cellPx));
+        m_rows = std::max(1, (int)std::ceil(worldH/cellPx));
+        m_cells.assign((std::size_t)m_cols*m_rows, {});
+        m_slots[0].clear(); m_slots[1].clear();
+    }
+    bool ready() const { return !m_cells.empty(); }
+
+    // Positions outside the world clamp to the border cells
+    int cellOf(sf::Vector2f p) const{
+        int cx = std::min(m_cols-1, std::max(0, (int)std::floor(p.x/m_cell)));
+        int cy = std::min(m_rows-1, std::max(0, (int)std::floor(p.y/m_cell)));
+        return cy*m_cols + cx;
+    }
+
+    // Inserts or moves; returns true when the handle changed cell
+    bool place(std::uint32_t h, sf::Vector2f p){
+        if(!ready()) return false;
+        int& s = slot(h);
+        int c = cellOf(p);
+        if(s == c) return false;
+        if(s >= 0) erase(s, h);
+        m_cells[c].push_back(h);
+        s = c;
+        return true;
+    }
+    void remove(std::uint32_t h){
+        if(!ready()) return;
+        int& s = slot(h);
+        if(s >= 0){ erase(s, h); s = -1; }
+    }
+
+    // f(handle) for every handle in the cells touching r (candidates: the
+    // caller still checks exact positions)
+    template<class F>
+    void query(const sf::FloatRect& r, F&& f) const{
+        if(!ready()) return;
+        int a = cellOf({r.left, r.top}), b = cellOf({r.left + r.width, r.top + r.height});
+        for(int cy=a/m_cols; cy<=b/m_cols; ++cy)
+            for(int cx=a%m_cols; cx<=b%m_cols; ++cx)
+                for(std::uint32_t h : m_cells[(std::size_t)cy*m_cols + cx]) f(h);
+    }
+
+    int cols() const { return m_cols; }
+    int rows() const { return m_rows; }
+    float cellSize() const { return m_cell; }
+
+private:
+    int& slot(std::uint32_t h){
+        auto& t = m_slots[(h & kHighBit) ? 1 : 0];
+        std::uint32_t i = h & ~kHighBit;
+        if(i >= t.size()) t.resize(i+1, -1);
+        return t[i];
+    }
+    void erase(int cell, std::uint32_t h){
+        auto& b = m_cells[cell];
+        auto it = std::find(b.begin(), b.end(), h);
+        if(it != b.end()){ *it = b.back(); b.pop_back(); }
+    }
+
+    float m_cell=64.f;
+    int m_cols=0, m_rows=0;
+    std::vector<std::vector<std::uint32_t>> m_cells;
+    std::vector<int> m_slots[2]; // cell per handle, -1 = not in the grid
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Escritor/lector a nivel de bits para los paquetes de red. Los enteros chicos
+// van como varint de nibbles (3 bits de dato + 1 de continuación por grupo), así
+// que 0..7 cuesta 4 bits; los deltas con signo pasan antes por zigzag.
+class BitWriter {
+public:
+    void bits(std::uint32_t v, int n){
+        for(int i=0;i<n;++i){
+            if(m_bit==0) m_buf.push_back(0);
+            if((v>>i)&1u) m_buf.back() |= (std::uint8_t)(1u<<m_bit);
+            m_bit = (m_bit+1)&7;
+        }
+    }
+    void flag(bool b){ bits(b?1u:0u, 1); }
+    void var(std::uint32_t v){
+        while(v >= 8){ bits((v&7u)|8u, 4); v >>= 3; }
+        bits(v, 4);
+    }
+    void svar(std::int32_t v){ var(((std::uint32_t)v << 1) ^ (std::uint32_t)(v >> 31)); }
+    void u32(std::uint32_t v){ bits(v, 32); }
+
+    const std::vector<std::uint8_t>& data() const { return m_buf; }
+    void clear(){ m_buf.clear(); m_bit=0; }
+private:
+    std::vector<std::uint8_t> m_buf;
+    int m_bit=0;
+};
+
+class BitReader {
+public:
+    BitReader(const std::uint8_t* data, std::size_t size) : m_data(data), m_size(size) {}
+
+    std::uint32_t bits(int n){
+        std::uint32_t v=0;
+        for(int i=0;i<n;++i){
+            if(m_pos >= m_size*8){ m_overrun=true; return 0; }
+            if((m_data[m_pos>>3] >> (m_pos&7)) & 1u) v |= 1u<<i;
+            ++m_pos;
+        }
+        return v;
+    }
+    bool flag(){ return bits(1)!=0; }
+    std::uint32_t var(){
+        std::uint32_t v=0; int shift=0;
+        for(;;){
+            std::uint32_t g = bits(4);
+            if(shift < 32) v |= (g&7u) << shift;
+            if(!(g&8u) || m_overrun) return v;
+            shift += 3;
+        }
+    }
+    std::int32_t svar(){ std::uint32_t u = var(); return (std::int32_t)(u>>1) ^ -(std::int32_t)(u&1u); }
+    std::uint32_t u32(){ return bits(32); }
+
+    // true si el paquete era más corto que lo leído (corrupto/truncado)
+    bool overrun() const { return m_overrun; }
+private:
+    const std::uint8_t* m_data;
+    std::size_t m_size;
+    std::size_t m_pos=0;
+    bool m_overrun=false;
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Orden de un jugador tal como viaja en el lockstep. Por la red solo van las
+// órdenes; cada peer aplica las mismas órdenes en el mismo tick y simula el resto.
+enum class CommandType : std::uint8_t { Move=0, Queue=1, Build=2, PlaceMine=3 };
+
+// Referencia a una unidad dentro de una orden: índice en allies_, o en
+// bulldozers_ si el bit alto está prendido. Ambos vectores solo crecen, así que
+// los índices son estables.
+using UnitRef = std::uint32_t;
+constexpr UnitRef kDozerRef = 0x80000000u;
+inline UnitRef allyRef(std::uint32_t i){ return i; }
+inline UnitRef dozerRef(std::uint32_t i){ return i | kDozerRef; }
+
+struct Command {
+    CommandType   type{CommandType::Move};
+    std::int32_t  x{0}, y{0};      // px de mundo (Move/Build/PlaceMine)
+    std::uint8_t  building{0};     // Queue: Building::Type
+    std::uint8_t  unit{0};         // Queue: UnitType
+    std::uint8_t  priority{0};     // Build
+    std::vector<UnitRef> units;    // Move: orden ascendente
+};
@@ -0,0 +1,254 @@
+#include "Lockstep.hpp"
+#include <algorithm>
+#include <iostream>
+
+Lockstep::Lockstep(int localPlayer, int players, int inputDelay)
+    : m_local(localPlayer), m_players(std::max(1, players)), m_delay(std::max(1, inputDelay)),
+      m_schedule(kWindow), m_outbox(kWindow), m_localHash(kWindow), m_peerHash(kWindow) {
+    for(Slot& s : m_schedule){ s.byPlayer.resize(m_players); s.have.assign(m_players, 0); }
+    // Los primeros inputDelay ticks no tienen órdenes para nadie
+    for(std::uint32_t t=0; t<(std::uint32_t)m_delay; ++t){
+        Slot& s = slot(t);
+        for(int p=0;p<m_players;++p) s.have[p] = 1;
+    }
+}
+
+void Lockstep::addPeer(int player, std::unique_ptr<Transport> link){
+    Peer p;
+    p.player = player;
+    p.link = std::move(link);
+    p.acked = p.contiguous = (std::uint32_t)m_delay;
+    m_peers.push_back(std::move(p));
+}
+
+// Entrada del anillo para t; si tenía un tick viejo se vacía (clear conserva la capacidad)
+Lockstep::Slot& Lockstep::slot(std::uint32_t t){
+    Slot& s = m_schedule[t % kWindow];
+    if(s.tick != t){
+        s.tick = t;
+        for(auto& b : s.byPlayer) b.clear();
+        std::fill(s.have.begin(), s.have.end(), 0);
+    }
+    return s;
+}
+
+const Lockstep::Slot* Lockstep::find(std::uint32_t t) const{
+    const Slot& s = m_schedule[t % kWindow];
+    return s.tick == t ? &s : nullptr;
+}
+
+void Lockstep::store(std::uint32_t t, int player, std::vector<Command>& cmds){
+    if(t < m_tick || t >= m_tick + kWindow || player < 0 || player >= m_players) return;
+    Slot& s = slot(t);
+    if(s.have[player]) return; // reenvío repetido
+    s.byPlayer[player].swap(cmds);
+    cmds.clear();
+    s.have[player] = 1;
+}
+
+bool Lockstep::ready() const{
+    const Slot* s = find(m_tick);
+    if(!s) return false;
+    for(char h : s->have) if(!h) return false;
+    return true;
+}
+
+const std::vector<Command>& Lockstep::commands(){
+    m_merged.clear();
+    if(const Slot* s = find(m_tick))
+        for(auto& batch : s->byPlayer)
+            m_merged.insert(m_merged.end(), batch.begin(), batch.end());
+    return m_merged;
+}
+
+void Lockstep::advance(std::uint32_t stateHash){
+    if(stateHash != kNoHash){
+        m_localHash[m_tick % kWindow] = { m_tick, stateHash };
+        m_lastHashTick = m_tick;
+        checkHash(m_tick);
+    }
+
+    // Sella las órdenes locales para tick+delay (la copia del outbox reusa su capacidad)
+    std::uint32_t sealT = m_tick + (std::uint32_t)m_delay;
+    if(networked()){
+        Sealed& o = m_outbox[sealT % kWindow];
+        o.tick = sealT;
+        o.cmds = m_pending;
+    }
+    store(sealT, m_local, m_pending);
+    ++m_tick;
+
+    for(auto& p : m_peers) sendTo(p);
+}
+
+void Lockstep::pump(){
+    for(auto& p : m_peers)
+        while(p.link->receive(m_rx)) receive(p, m_rx);
+    // Trabados esperando a un peer: reenviar lo no confirmado
+    if(networked() && !ready())
+        for(auto& p : m_peers) sendTo(p);
+}
+
+void Lockstep::sendTo(Peer& p){
+    std::uint32_t sealedEnd = m_tick + (std::uint32_t)m_delay; // ticks < sealedEnd ya sellados
+    std::uint32_t first = p.acked;
+    std::uint32_t limit = std::min(sealedEnd, first + kMaxTicksPerPacket);
+    static const std::vector<Command> kEmpty;
+    auto batch = [&](std::uint32_t t) -> const std::vector<Command>& {
+        const Sealed& o = m_outbox[t % kWindow];
+        return o.tick == t ? o.cmds : kEmpty;
+    };
+
+    // Ticks que entran en kPacketBudget; siempre al menos uno (si no, nunca avanza el ack).
+    // Lo que queda afuera sale en el próximo paquete, cuando el peer confirme estos
+    std::uint32_t last = first;
+    {
+        m_sizer.clear();
+        std::int32_t sx=0, sy=0;
+        while(last < limit){
+            encodeBatch(m_sizer, batch(last), sx, sy);
+            if(last > first && m_sizer.data().size() > kPacketBudget) break;
+            ++last;
+        }
+    }
+
+    m_writer.clear();
+    m_writer.var((std::uint32_t)m_local);
+    m_writer.var(p.contiguous);
+    m_writer.var(first);
+    m_writer.var(last > first ? last - first : 0);
+    std::int32_t px=0, py=0;
+    for(std::uint32_t t=first; t<last; ++t) encodeBatch(m_writer, batch(t), px, py);
+    m_writer.flag(m_lastHashTick != kNone);
+    if(m_lastHashTick != kNone){
+        m_writer.var(m_lastHashTick);
+        m_writer.u32(m_localHash[m_lastHashTick % kWindow].hash);
+    }
+    p.link->send(m_writer.data());
+    m_bytesSent += m_writer.data().size();
+    ++m_packetsSent;
+}
+
+void Lockstep::receive(Peer& p, const std::vector<std::uint8_t>& packet){
+    BitReader r(packet.data(), packet.size());
+    if((int)r.var() != p.player) return;
+    std::uint32_t ack   = r.var();
+    std::uint32_t first = r.var();
+    std::uint32_t count = r.var();
+    if(count > kMaxTicksPerPacket) return;
+
+    if(m_rxBatches.size() < count) m_rxBatches.resize(count);
+    std::int32_t px=0, py=0;
+    for(std::uint32_t i=0;i<count;++i){
+        m_rxBatches[i].clear();
+        if(!decodeBatch(r, m_rxBatches[i], px, py)) return;
+    }
+    bool hasHash = r.flag();
+    std::uint32_t hashTick = hasHash ? r.var() : 0;
+    std::uint32_t hash     = hasHash ? r.u32() : 0;
+    if(r.overrun()) return; // paquete truncado: se ignora entero
+
+    p.acked = std::max(p.acked, ack);
+    for(std::uint32_t i=0;i<count;++i) store(first+i, p.player, m_rxBatches[i]);
+    for(;;){
+        const Slot* s = find(p.contiguous);
+        if(!s || !s->have[p.player]) break;
+        ++p.contiguous;
+    }
+
+    TickHash& theirs = m_peerHash[hashTick % kWindow];
+    if(hasHash && theirs.tick != hashTick){
+        theirs = { hashTick, hash };
+        checkHash(hashTick);
+    }
+}
+
+void Lockstep::checkHash(std::uint32_t t){
+    const TickHash& mine = m_localHash[t % kWindow];
+    TickHash& theirs = m_peerHash[t % kWindow];
+    if(mine.tick != t || theirs.tick != t) return;
+    if(mine.hash != theirs.hash && m_desyncTick == kNone){
+        m_desyncTick = t;
+        std::cerr << "[lockstep] DESYNC en tick " << t << " (local " << std::hex << mine.hash
+                  << " / remoto " << theirs.hash << std::dec << ")\n";
+    }
+    theirs.tick = kNone; // ya comparado
+}
+
+// ---- Codificación de lotes ----
+// Posiciones: delta contra el comando anterior del paquete (px,py).
+// Unidades: aliados y dozers por separado, índices ordenados como saltos.
+static void encodeRefs(BitWriter& w, const std::vector<UnitRef>& units, bool dozers){
+    std::uint32_t n=0;
+    for(UnitRef u : units) if(((u & kDozerRef)!=0) == dozers) ++n;
+    w.var(n);
+    std::uint32_t prev=0;
+    for(UnitRef u : units){
+        if(((u & kDozerRef)!=0) != dozers) continue;
+        std::uint32_t idx = u & ~kDozerRef;
+        w.var(idx - prev);
+        prev = idx;
+    }
+}
+static bool decodeRefs(BitReader& r, std::vector<UnitRef>& units, bool dozers){
+    std::uint32_t n = r.var();
+    if(n > 65536 || r.overrun()) return false;
+    std::uint32_t idx=0;
+    for(std::uint32_t i=0;i<n;++i){
+        idx += r.var();
+        units.push_back(dozers ? dozerRef(idx) : allyRef(idx));
+    }
+    return !r.overrun();
+}
+
+void Lockstep::encodeBatch(BitWriter& w, const std::vector<Command>& cmds, std::int32_t& px, std::int32_t& py){
+    w.var((std::uint32_t)cmds.size());
+    for(const Command& c : cmds){
+        w.bits((std::uint32_t)c.type, 2);
+        switch(c.type){
+        case CommandType::Move:
+            w.svar(c.x-px); w.svar(c.y-py); px=c.x; py=c.y;
+            encodeRefs(w, c.units, false);
+            encodeRefs(w, c.units, true);
+            break;
+        case CommandType::Queue:
+            w.bits(c.building, 2);
+            w.bits(c.unit, 3);
+            break;
+        case CommandType::Build:
+            w.svar(c.x-px); w.svar(c.y-py); px=c.x; py=c.y;
+            w.var(c.priority);
+            break;
+        case CommandType::PlaceMine:
+            w.svar(c.x-px); w.svar(c.y-py); px=c.x; py=c.y;
+            break;
+        }
+    }
+}
+
+bool Lockstep::decodeBatch(BitReader& r, std::vector<Command>& cmds, std::int32_t& px, std::int32_t& py){
+    std::uint32_t n = r.var();
+    if(n > 1024 || r.overrun()) return false;
+    cmds.resize(n);
+    for(Command& c : cmds){
+        c.type = (CommandType)r.bits(2);
+        switch(c.type){
+        case CommandType::Move:
+            c.x = px += r.svar(); c.y = py += r.svar();
+            if(!decodeRefs(r, c.units, false) || !decodeRefs(r, c.units, true)) return false;
+            break;
+        case CommandType::Queue:
+            c.building = (std::uint8_t)r.bits(2);
+            c.unit     = (std::uint8_t)r.bits(3);
+            break;
+        case CommandType::Build:
+            c.x = px += r.svar(); c.y = py += r.svar();
+            c.priority = (std::uint8_t)r.var();
+            break;
+        case CommandType::PlaceMine:
+            c.x = px += r.svar(); c.y = py += r.svar();
+            break;
+        }
+    }
+    return !r.overrun();
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Command.hpp"
+#include "Transport.hpp"
+#include "BitStream.hpp"
+
+// Lockstep determinista. La simulación avanza en ticks fijos; el tick T recién
+// corre cuando se conoce el lote de órdenes de todos los jugadores para T. Las
+// órdenes locales se agendan inputDelay ticks adelante para que lleguen a
+// tiempo a los peers.
+//
+// Por peer, cada paquete lleva nuestros lotes que el peer todavía no confirmó
+// (un datagrama perdido lo cubre el siguiente), nuestro ack de los suyos y el
+// hash de estado de nuestro último tick simulado para detectar desync. Los
+// lotes van empaquetados en bits y codificados por deltas (posiciones contra el
+// comando anterior, listas de unidades como saltos), así que el tráfico depende
+// de las órdenes dadas, no del tamaño del ejército.
+//
+// Lotes, lotes sellados y hashes viven en anillos de kWindow ticks indexados
+// por tick % kWindow (cada entrada sabe de qué tick es), así que en régimen
+// estable avanzar un tick no pide memoria al heap.
+class Lockstep {
+public:
+    explicit Lockstep(int localPlayer=0, int players=1, int inputDelay=3);
+
+    void addPeer(int player, std::unique_ptr<Transport> link);
+    bool networked() const { return !m_peers.empty(); }
+
+    // Orden local para tick()+inputDelay
+    void submit(Command c){ m_pending.push_back(std::move(c)); }
+
+    // Por frame: vacía los paquetes entrantes; reenvía si estamos trabados esperando peers
+    void pump();
+    // ¿Están todos los lotes de tick()?
+    bool ready() const;
+    // Lote combinado de tick(), jugador 0 primero (mismo orden en todos los peers)
+    const std::vector<Command>& commands();
+    // Tick simulado: guarda su hash, sella el siguiente lote local y envía.
+    // Con kNoHash el tick no se compara (no se calculó el hash)
+    static constexpr std::uint32_t kNoHash = 0xFFFFFFFFu;
+    void advance(std::uint32_t stateHash);
+
+    std::uint32_t tick() const { return m_tick; }
+    bool desynced() const { return m_desyncTick != kNone; }
+    std::uint32_t desyncTick() const { return m_desyncTick; }
+    std::uint64_t bytesSent() const { return m_bytesSent; }
+    std::uint64_t packetsSent() const { return m_packetsSent; }
+
+private:
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+    static constexpr std::uint32_t kMaxTicksPerPacket = 64;
+    static constexpr std::size_t   kPacketBudget = 1200; // bytes de lotes por paquete (entra en un MTU típico)
+    static constexpr std::uint32_t kWindow = 256;        // ticks en vuelo (lejos de 2*inputDelay + un paquete)
+
+    struct Slot {
+        std::uint32_t tick{kNone};
+        std::vector<std::vector<Command>> byPlayer;
+        std::vector<char> have;
+    };
+    struct Sealed {
+        std::uint32_t tick{kNone};
+        std::vector<Command> cmds;
+    };
+    struct TickHash {
+        std::uint32_t tick{kNone};
+        std::uint32_t hash{0};
+    };
+    struct Peer {
+        int player;
+        std::unique_ptr<Transport> link;
+        std::uint32_t acked{0};      // el peer tiene todos nuestros lotes < acked
+        std::uint32_t contiguous{0}; // tenemos todos sus lotes < contiguous
+    };
+
+    Slot& slot(std::uint32_t t);
+    const Slot* find(std::uint32_t t) const;
+    // Pasa cmds al lote de t con swap: cmds se lleva la capacidad vieja del slot
+    void store(std::uint32_t t, int player, std::vector<Command>& cmds);
+    void sendTo(Peer& p);
+    void receive(Peer& p, const std::vector<std::uint8_t>& packet);
+    void checkHash(std::uint32_t t);
+
+    static void encodeBatch(BitWriter& w, const std::vector<Command>& cmds, std::int32_t& px, std::int32_t& py);
+    static bool decodeBatch(BitReader& r, std::vector<Command>& cmds, std::int32_t& px, std::int32_t& py);
+
+    int m_local, m_players, m_delay;
+    std::uint32_t m_tick{0};
+    std::vector<Command> m_pending;                        // todavía sin sellar
+    std::vector<Slot>    m_schedule;                       // anillo: ticks >= m_tick
+    std::vector<Sealed>  m_outbox;                         // anillo: lotes nuestros sellados (para reenviar)
+    std::vector<Command> m_merged;
+    std::vector<Peer> m_peers;
+
+    std::vector<TickHash> m_localHash;                     // anillo: ticks recientes
+    std::vector<TickHash> m_peerHash;                      // anillo: esperando nuestro propio hash
+    std::uint32_t m_lastHashTick{kNone};
+    std::uint32_t m_desyncTick{kNone};
+
+    BitWriter m_writer, m_sizer;
+    std::vector<std::uint8_t> m_rx;
+    std::vector<std::vector<Command>> m_rxBatches;
+    std::uint64_t m_bytesSent{0}, m_packetsSent{0};
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <SFML/Network.hpp>
+
+// Enlace de datagramas no confiable con un peer remoto. Lockstep pone encima
+// sus propios acks/reenvíos, así que las pérdidas y el desorden no importan.
+class Transport {
+public:
+    virtual ~Transport() = default;
+    virtual void send(const std::vector<std::uint8_t>& packet) = 0;
+    // No bloquea; false si no hay nada pendiente
+    virtual bool receive(std::vector<std::uint8_t>& packet) = 0;
+};
+
+// Par de extremos en el mismo proceso (pruebas, dos jugadores locales, soak --peers 2)
+class LoopbackTransport : public Transport {
+public:
+    static std::pair<std::unique_ptr<LoopbackTransport>, std::unique_ptr<LoopbackTransport>> makePair(){
+        auto a2b = std::make_shared<std::deque<std::vector<std::uint8_t>>>();
+        auto b2a = std::make_shared<std::deque<std::vector<std::uint8_t>>>();
+        return { std::unique_ptr<LoopbackTransport>(new LoopbackTransport(a2b, b2a)),
+                 std::unique_ptr<LoopbackTransport>(new LoopbackTransport(b2a, a2b)) };
+    }
+    void send(const std::vector<std::uint8_t>& packet) override { m_out->push_back(packet); }
+    bool receive(std::vector<std::uint8_t>& packet) override{
+        if(m_in->empty()) return false;
+        packet = std::move(m_in->front()); m_in->pop_front();
+        return true;
+    }
+private:
+    using Queue = std::deque<std::vector<std::uint8_t>>;
+    LoopbackTransport(std::shared_ptr<Queue> out, std::shared_ptr<Queue> in) : m_out(std::move(out)), m_in(std::move(in)) {}
+    std::shared_ptr<Queue> m_out, m_in;
+};
+
+// UDP a un peer fijo (p.ej. 127.0.0.1 para dos instancias en la misma máquina)
+class UdpTransport : public Transport {
+public:
+    bool open(unsigned short localPort, const std::string& peerHost, unsigned short peerPort){
+        m_peer = sf::IpAddress(peerHost);
+        m_peerPort = peerPort;
+        m_socket.setBlocking(false);
+        return m_peer != sf::IpAddress::None && m_socket.bind(localPort) == sf::Socket::Done;
+    }
+    void send(const std::vector<std::uint8_t>& packet) override{
+        m_socket.send(packet.data(), packet.size(), m_peer, m_peerPort);
+    }
+    bool receive(std::vector<std::uint8_t>& packet) override{
+        std::size_t got = 0;
+        sf::IpAddress from; unsigned short port = 0;
+        while(m_socket.receive(m_buf.data(), m_buf.size(), got, from, port) == sf::Socket::Done){
+            if(from != m_peer || port != m_peerPort) continue; // se ignora a los desconocidos
+            packet.assign(m_buf.data(), m_buf.data()+got);
+            return true;
+        }
+        return false;
+    }
+    // Máximo payload UDP sobre IPv4: al recibir nunca se trunca un datagrama
+    static constexpr std::size_t kMaxDatagram = 65507;
+private:
+    std::array<std::uint8_t, kMaxDatagram> m_buf{};
+    sf::UdpSocket  m_socket;
+    sf::IpAddress  m_peer;
+    unsigned short m_peerPort{0};
+};
@@ -0,0 +1,152 @@
+#include "Minimap.hpp"
+#include <algorithm>
+
+// Index of the lowest set bit (x != 0)
+static inline int lowestBit(std::uint64_t x){
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int b=0; while(!((x>>b)&1u)) ++b;
+    return b;
+#endif
+}
+// Dot color packed as RGB + 0xFF (texels are opaque), so 0 means "no dot"
+static inline std::uint32_t packDot(sf::Color c){ return ((std::uint32_t)c.r<<24) | ((std::uint32_t)c.g<<16) | ((std::uint32_t)c.b<<8) | 0xFFu; }
+static inline sf::Color unpackDot(std::uint32_t v){ return sf::Color((sf::Uint8)(v>>24), (sf::Uint8)(v>>16), (sf::Uint8)(v>>8)); }
+
+void Minimap::init(const TileMap& map, const FogOfWar& fog, int team){
+    m_map=&map; m_fog=&fog; m_team=team;
+    m_w=map.width(); m_h=map.height();
+    m_pixels.assign((std::size_t)m_w*m_h*4, 0);
+    m_lastVis.assign((std::size_t)m_h*fog.wordsPerRow(), 0);
+    m_lastExp.assign((std::size_t)m_h*fog.wordsPerRow(), 0);
+    m_dots.clear(); m_prevDots.clear();
+    m_painted.assign((std::size_t)m_w*m_h, 0);
+    m_want.assign((std::size_t)m_w*m_h, 0);
+    for(int y=0;y<m_h;++y) for(int x=0;x<m_w;++x) writeTexel(x,y,baseColor(x,y));
+    m_tex = std::make_unique<sf::Texture>();
+    m_tex->create(m_w, m_h);
+    m_tex->update(m_pixels.data());
+    m_sprite.setTexture(*m_tex, true);
+    m_dx0=0; m_dy0=0; m_dx1=-1; m_dy1=-1;
+}
+
+void Minimap::invalidateTile(int gx,int gy){
+    if(!m_map || !m_map->inBounds(gx,gy)) return;
+    if(m_painted[(std::size_t)gy*m_w+gx]) return; // under a dot; repainted when the dot leaves
+    writeTexel(gx,gy,baseColor(gx,gy));
+}
+
+void Minimap::beginDots(){ std::swap(m_dots, m_prevDots); m_dots.clear(); }
+void Minimap::addDot(sf::Vector2f world, sf::Color c){
+    int gx=(int)(world.x/64), gy=(int)(world.y/64);
+    if(m_map && m_map->inBounds(gx,gy)) m_dots.push_back({gy*m_w+gx, c});
+}
+
+sf::Color Minimap::baseColor(int gx,int gy) const{
+    if(!m_fog->isExplored(m_team,gx,gy)) return sf::Color(0,0,0);
+    sf::Color c = TileMap::colorOf(m_map->tileAt(gx,gy));
+    if(!m_fog->isVisible(m_team,gx,gy)){ c.r/=2; c.g/=2; c.b/=2; }
+    return c;
+}
+
+void Minimap::writeTexel(int gx,int gy,sf::Color c){
+    sf::Uint8* p = &m_pixels[((std::size_t)gy*m_w+gx)*4];
+    if(p[0]==c.r && p[1]==c.g && p[2]==c.b && p[3]==255) return;
+    p[0]=c.r; p[1]=c.g; p[2]=c.b; p[3]=255;
+    touch(gx,gy);
+}
+
+void Minimap::touch(int gx,int gy){
+    if(m_dx1<m_dx0){ m_dx0=m_dx1=gx; m_dy0=m_dy1=gy; return; }
+    m_dx0=std::min(m_dx0,gx); m_dx1=std::max(m_dx1,gx);
+    m_dy0=std::min(m_dy0,gy); m_dy1=std::max(m_dy1,gy);
+}
+
+void Minimap::update(){
+    if(!m_map) return;
+    // 1) Fog: compare packed rows, recolor only the bits that flipped
+    const int wpr = m_fog->wordsPerRow();
+    for(int y=0;y<m_h;++y){
+        const std::uint64_t* vis = m_fog->visibleRow(m_team,y);
+        const std::uint64_t* exp = m_fog->exploredRow(m_team,y);
+        std::uint64_t* lv = &m_lastVis[(std::size_t)y*wpr];
+        std::uint64_t* le = &m_lastExp[(std::size_t)y*wpr];
+        for(int w=0;w<wpr;++w){
+            std::uint64_t diff = (vis[w]^lv[w]) | (exp[w]^le[w]);
+            lv[w]=vis[w]; le[w]=exp[w];
+            while(diff){
+                int x = w*64 + lowestBit(diff);
+                diff &= diff-1;
+                if(x<m_w && !m_painted[(std::size_t)y*m_w+x]) writeTexel(x,y,baseColor(x,y));
+            }
+        }
+    }
+    // 2) Dots: only texels whose dot appeared, left or changed color are
+    //    rewritten, so a still army adds nothing to the dirty rect
+    for(const Dot& d : m_dots) m_want[d.idx] = packDot(d.c); // last dot on a texel wins
+    for(const Dot& d : m_prevDots)
+        if(!m_want[d.idx] && m_painted[d.idx]){
+            m_painted[d.idx] = 0;
+            writeTexel(d.idx%m_w, d.idx/m_w, baseColor(d.idx%m_w, d.idx/m_w));
+        }
+    for(const Dot& d : m_dots){
+        std::uint32_t want = m_want[d.idx];
+        if(!want) continue; // texel already handled
+        if(m_painted[d.idx] != want){
+            m_painted[d.idx] = want;
+            writeTexel(d.idx%m_w, d.idx/m_w, unpackDot(want));
+        }
+        m_want[d.idx] = 0;
+    }
+
+    // 3) Upload only the dirty rectangle
+    if(m_dx1<m_dx0) return;
+    int rw = m_dx1-m_dx0+1, rh = m_dy1-m_dy0+1;
+    m_upload.resize((std::size_t)rw*rh*4);
+    for(int y=0;y<rh;++y)
+        std::copy_n(&m_pixels[((std::size_t)(m_dy0+y)*m_w + m_dx0)*4], rw*4, &m_upload[(std::size_t)y*rw*4]);
+    m_tex->update(m_upload.data(), rw, rh, m_dx0, m_dy0);
+    m_dx0=0; m_dy0=0; m_dx1=-1; m_dy1=-1;
+}
+
+sf::FloatRect Minimap::panelRect(const sf::RenderWindow& win) const{
+    float scale = m_panelSize / (float)std::max(m_w, m_h);
+    float pw = m_w*scale, ph = m_h*scale;
+    sf::Vector2f ws = win.getDefaultView().getSize();
+    return sf::FloatRect(ws.x - pw - 10.f, ws.y - ph - 10.f, pw, ph);
+}
+
+void Minimap::draw(sf::RenderWindow& win, const sf::View& cam){
+    if(!m_map) return;
+    sf::View prev = win.getView();
+    win.setView(win.getDefaultView());
+
+    sf::FloatRect pr = panelRect(win);
+    float scale = pr.width / (float)m_w;
+    m_sprite.setPosition(pr.left, pr.top);
+    m_sprite.setScale(scale, scale);
+    win.draw(m_sprite);
+
+    // Marco de la cámara (tiles → px del panel)
+    sf::RectangleShape& view = m_frame;
+    view.setSize({cam.getSize().x/64.f*scale, cam.getSize().y/64.f*scale});
+    view.setPosition(pr.left + (cam.getCenter().x - cam.getSize().x/2)/64.f*scale,
+                     pr.top  + (cam.getCenter().y - cam.getSize().y/2)/64.f*scale);
+    view.setFillColor(sf::Color::Transparent);
+    view.setOutlineColor(sf::Color::White);
+    view.setOutlineThickness(1.f);
+    win.draw(view);
+
+    win.setView(prev);
+}
+
+bool Minimap::screenToWorld(sf::RenderWindow& win, sf::Vector2i mouse, sf::Vector2f& out) const{
+    if(!m_map) return false;
+    sf::FloatRect pr = panelRect(win);
+    sf::Vector2f p = win.mapPixelToCoords(mouse, win.getDefaultView());
+    if(!pr.contains(p)) return false;
+    float scale = pr.width / (float)m_w;
+    out = { (p.x-pr.left)/scale*64.f, (p.y-pr.top)/scale*64.f };
+    return true;
+}
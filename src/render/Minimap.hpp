@@ -0,0 +1,52 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../map/TileMap.hpp"
+#include "../map/FogOfWar.hpp"
+
+// Minimap: one texel per tile, drawn as a single textured quad.
+// The texel buffer is kept on the CPU; each frame only the tiles whose fog
+// bits flipped and the texels under old/new unit dots are rewritten, and only
+// their bounding rectangle is re-uploaded to the texture.
+class Minimap{
+public:
+    // Creates the texture too, so it belongs on the main thread (finishLoad)
+    void init(const TileMap& map, const FogOfWar& fog, int team=0);
+    // Marks tile (gx,gy) for a recolor (tile type changed)
+    void invalidateTile(int gx,int gy);
+
+    // Unit dots for this frame (world positions): beginDots() then addDot() per unit
+    void beginDots();
+    void addDot(sf::Vector2f world, sf::Color c);
+
+    void update();
+    void draw(sf::RenderWindow& win, const sf::View& cam);
+
+    // Screen-space hit test; on hit writes the world point under the cursor
+    bool screenToWorld(sf::RenderWindow& win, sf::Vector2i mouse, sf::Vector2f& out) const;
+
+private:
+    sf::Color baseColor(int gx,int gy) const;
+    void writeTexel(int gx,int gy,sf::Color c);
+    void touch(int gx,int gy);
+    sf::FloatRect panelRect(const sf::RenderWindow& win) const;
+
+    const TileMap*  m_map=nullptr;
+    const FogOfWar* m_fog=nullptr;
+    int m_team=0, m_w=0, m_h=0;
+
+    std::vector<sf::Uint8>     m_pixels;              // RGBA, m_w*m_h
+    std::vector<std::uint64_t> m_lastVis, m_lastExp;  // fog bits at last update
+    struct Dot{ int idx; sf::Color c; };
+    std::vector<Dot>           m_dots, m_prevDots;    // this frame's / last frame's dots
+    std::vector<std::uint32_t> m_painted, m_want;     // per texel: dot color on it / wanted now (0 = none)
+    std::vector<sf::Uint8>     m_upload;              // scratch for the dirty rect
+    int m_dx0=0, m_dy0=0, m_dx1=-1, m_dy1=-1;         // dirty rect (inclusive)
+
+    std::unique_ptr<sf::Texture> m_tex; // made in init(): a plain member would open the display even headless
+    sf::Sprite  m_sprite;
+    sf::RectangleShape m_frame;
+    float       m_panelSize{180.f};
+};
@@ -0,0 +1,230 @@
+// ArmyMenSoak: corre escenarios generados sin ventana durante N minutos de juego
+// y escribe a CSV percentiles de tiempo por frame, memoria y cantidad de entidades.
+//
+//   ArmyMenSoak [--scenario SPEC]... [--minutes N] [--seed S] [--csv archivo] [--budget-ms B] [--peers 1|2]
+//
+// SPEC es "preset[,clave=valor...]" (ver src/game/Scenario.hpp). Sin --scenario
+// corren todos los presets de menor a mayor. Una fila por minuto simulado y una
+// fila "total" por escenario, para ver dónde se rompe la escala.
+//
+// --peers 2: dos PlayState en el proceso, en lockstep sobre LoopbackTransport.
+// Las órdenes scripted entran por el jugador 0 y viajan codificadas al 1; al
+// final de cada frame se comparan los hashes de estado de ambos. El tiempo por
+// frame medido es el del jugador 0, y net_bytes_per_tick es lo que envía el
+// jugador 0 por tick simulado (no debería crecer con el ejército).
+#include "core/Game.hpp"
+#include "game/PlayState.hpp"
+#include "game/Scenario.hpp"
+#include "net/Transport.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float kFrameDt = 1.f/60.f; // un tick de lockstep por frame
+
+// RSS actual (Linux: /proc/self/statm); 0 donde no se puede leer
+long currentRssKb(){
+#if defined(__linux__)
+    long pages=0, resident=0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")){
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+    return 0;
+#endif
+}
+
+// Máximo RSS del proceso desde que arrancó (getrusage)
+long peakRssKb(){
+#if defined(__APPLE__)
+    rusage ru{}; getrusage(RUSAGE_SELF, &ru); return ru.ru_maxrss / 1024; // bytes en macOS
+#elif defined(__unix__)
+    rusage ru{}; getrusage(RUSAGE_SELF, &ru); return ru.ru_maxrss;        // KB en Linux
+#else
+    return 0;
+#endif
+}
+
+struct FrameStats {
+    double mean=0, p50=0, p95=0, p99=0, max=0;
+};
+
+// Percentiles por rango más cercano; ordena la copia, no el original
+FrameStats summarize(std::vector<float> ms){
+    FrameStats s;
+    if (ms.empty()) return s;
+    std::sort(ms.begin(), ms.end());
+    auto pct = [&ms](double p){ return (double)ms[std::min(ms.size()-1, (std::size_t)(p * ms.size()))]; };
+    double sum = 0; for (float v : ms) sum += v;
+    s.mean = sum / ms.size();
+    s.p50 = pct(0.50); s.p95 = pct(0.95); s.p99 = pct(0.99);
+    s.max = ms.back();
+    return s;
+}
+
+void writeHeader(FILE* csv){
+    std::fprintf(csv, "scenario,seed,map_w,map_h,window,sim_s,frames,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,"
+                      "rss_kb,maxrss_kb,allies,dozers,buildings,mines,resources,build_jobs,plastic,orders,load_ms,peers,desync,net_bytes_per_tick,net_packets\n");
+}
+
+void writeRow(FILE* csv, const ScenarioConfig& cfg, const std::string& window, float simSeconds,
+              std::size_t frames, const FrameStats& fs, long rssKb, const PlayState::WorldStats& st,
+              unsigned orders, double loadMs, int peers, bool desync, double bytesPerTick, std::uint64_t packets){
+    std::fprintf(csv, "%s,%u,%d,%d,%s,%.1f,%zu,%.4f,%.4f,%.4f,%.4f,%.4f,%ld,%ld,%d,%d,%d,%d,%d,%d,%d,%u,%.1f,%d,%d,%.1f,%llu\n",
+        cfg.name.c_str(), (unsigned)cfg.seed, cfg.mapW, cfg.mapH, window.c_str(), simSeconds, frames,
+        fs.mean, fs.p50, fs.p95, fs.p99, fs.max, rssKb, peakRssKb(),
+        st.allies, st.dozers, st.buildings, st.mines, st.resources, st.buildJobs, st.plastic,
+        orders, loadMs, peers, desync ? 1 : 0, bytesPerTick, (unsigned long long)packets);
+    std::fflush(csv);
+}
+
+// Un escenario completo; devuelve false si el p99 total pasa el presupuesto
+// o si (con 2 peers) los estados divergieron
+bool runScenario(Game& game, const ScenarioConfig& cfg, float minutes, float budgetMs, int peers, FILE* csv){
+    auto t0 = Clock::now();
+    auto play = std::make_unique<PlayState>(game);
+    play->loadScenario(cfg);
+    double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    std::unique_ptr<PlayState> peer; // jugador 1 (solo con --peers 2)
+    if (peers == 2){
+        peer = std::make_unique<PlayState>(game);
+        peer->loadScenario(cfg);
+        auto link = LoopbackTransport::makePair();
+        play->connectPeer(0, std::move(link.first));
+        peer->connectPeer(1, std::move(link.second));
+    }
+    bool desync = false;
+
+    ScenarioScript script(cfg);
+    const std::size_t frames = (std::size_t)(minutes * 60.f / kFrameDt);
+    const std::size_t perWindow = (std::size_t)(60.f / kFrameDt); // un minuto simulado
+
+    std::vector<float> all, window;
+    all.reserve(frames);
+    window.reserve(perWindow);
+    long rssAll = currentRssKb(), rssWindow = rssAll;
+    PlayState::WorldStats net0 = play->stats(); // tráfico al empezar la ventana
+
+    // Bytes enviados por tick simulado desde `from`
+    auto bytesPerTick = [](const PlayState::WorldStats& from, const PlayState::WorldStats& to){
+        unsigned ticks = to.tick - from.tick;
+        return ticks ? double(to.netBytes - from.netBytes) / ticks : 0.0;
+    };
+
+    std::printf("[soak] %s: mapa %dx%d, %d unidades, %.1f min (carga %.1f ms)\n", cfg.name.c_str(), cfg.mapW, cfg.mapH,
+        cfg.soldiers + cfg.tanks + cfg.harvesters + cfg.minesweepers + cfg.bulldozers, minutes, loadMs);
+
+    for (std::size_t f=0; f<frames; ++f){
+        auto a = Clock::now();
+        script.update(kFrameDt, *play);
+        play->stepHeadless(kFrameDt);
+        float ms = std::chrono::duration<float, std::milli>(Clock::now() - a).count();
+        if (peer){
+            peer->stepHeadless(kFrameDt);
+            // Además del hash que intercambia Lockstep: mismo tick → mismo estado
+            if (peer->stats().tick == play->stats().tick && peer->simHash() != play->simHash()) desync = true;
+            desync = desync || play->desynced() || peer->desynced();
+        }
+        game.frameArena().reset();
+        all.push_back(ms);
+        window.push_back(ms);
+
+        if (f % 60 == 0) rssWindow = std::max(rssWindow, currentRssKb());
+        if (window.size() == perWindow || f+1 == frames){
+            char name[16]; std::snprintf(name, sizeof(name), "m%zu", f / perWindow + 1);
+            PlayState::WorldStats now = play->stats();
+            writeRow(csv, cfg, name, window.size() * kFrameDt, window.size(), summarize(window), rssWindow,
+                     now, script.ordersIssued(), loadMs, peers, desync,
+                     bytesPerTick(net0, now), now.netPackets - net0.netPackets);
+            net0 = now;
+            rssAll = std::max(rssAll, rssWindow);
+            window.clear();
+            rssWindow = currentRssKb();
+        }
+    }
+
+    FrameStats total = summarize(all);
+    PlayState::WorldStats st = play->stats();
+    const double netPerTick = bytesPerTick(PlayState::WorldStats{}, st);
+    writeRow(csv, cfg, "total", frames * kFrameDt, frames, total, rssAll, st, script.ordersIssued(), loadMs, peers, desync,
+             netPerTick, st.netPackets);
+
+    bool ok = total.p99 <= budgetMs && !desync;
+    std::printf("[soak] %s: p50 %.3f ms  p95 %.3f ms  p99 %.3f ms  max %.3f ms | RSS %ld KB | aliados %d, minas %d, edificios %d%s\n",
+        cfg.name.c_str(), total.p50, total.p95, total.p99, total.max, rssAll, st.allies, st.mines, st.buildings,
+        total.p99 <= budgetMs ? "" : "  ** SOBRE PRESUPUESTO **");
+    if (peer) std::printf("[soak] %s: 2 peers por loopback, tick %u, %.1f bytes/tick, %s\n", cfg.name.c_str(), st.tick,
+                          netPerTick, desync ? "** DESYNC **" : "hashes iguales");
+    return ok;
+}
+
+void usage(){
+    std::cerr << "uso: ArmyMenSoak [--scenario preset[,clave=valor...]]... [--minutes N] [--seed S]\n"
+                 "                  [--csv archivo] [--budget-ms B] [--peers 1|2]\n"
+                 "presets:";
+    for (auto& n : scenarioPresetNames()) std::cerr << ' ' << n;
+    std::cerr << '\n';
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+    std::vector<std::string> specs;
+    float minutes = 5.f;
+    float budgetMs = 1000.f / 60.f;
+    const char* csvPath = "soak.csv";
+    const char* seedArg = nullptr;
+    int peers = 1;
+
+    for (int i=1; i<argc; ++i){
+        auto arg = [&](const char* flag){ return std::strcmp(argv[i], flag) == 0 && i+1 < argc; };
+        if      (arg("--scenario"))  specs.push_back(argv[++i]);
+        else if (arg("--minutes"))   minutes = (float)std::atof(argv[++i]);
+        else if (arg("--seed"))      seedArg = argv[++i];
+        else if (arg("--csv"))       csvPath = argv[++i];
+        else if (arg("--budget-ms")) budgetMs = (float)std::atof(argv[++i]);
+        else if (arg("--peers"))     peers = std::atoi(argv[++i]);
+        else { usage(); return 2; }
+    }
+    if (specs.empty()) specs = scenarioPresetNames();
+    if (minutes <= 0.f || peers < 1 || peers > 2){ usage(); return 2; }
+
+    std::vector<ScenarioConfig> configs;
+    for (auto& spec : specs){
+        ScenarioConfig cfg;
+        if (!parseScenario(spec, cfg)){ std::cerr << "[soak] escenario inválido: " << spec << '\n'; usage(); return 2; }
+        if (seedArg) cfg.seed = (std::uint32_t)std::strtoul(seedArg, nullptr, 10);
+        configs.push_back(cfg);
+    }
+
+    FILE* csv = std::fopen(csvPath, "w");
+    if (!csv){ std::cerr << "[soak] no se pudo abrir " << csvPath << '\n'; return 2; }
+    writeHeader(csv);
+
+    Game game(Game::Mode::Headless);
+    bool ok = true;
+    for (auto& cfg : configs) ok = runScenario(game, cfg, minutes, budgetMs, peers, csv) && ok;
+
+    std::fclose(csv);
+    std::printf("[soak] CSV: %s\n", csvPath);
+    return ok ? 0 : 1;
+}